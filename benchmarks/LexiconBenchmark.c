@@ -0,0 +1,118 @@
+/**
+ * Benchmark of the lexicon lookups: builds a lexicon of synthetic words and measures
+ * the latency of looking up words that are present (hits) and words that are absent (misses)
+ *
+ * Usage: LexiconBenchmark [numberOfTerms] [lexiconPath]
+ * The lexicon is written to DEFAULT_LEXICON_PATH and removed at the end when no path is given
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../defs/Lexicon.h"
+#include "../defs/Utils.h"
+
+#define DEFAULT_NUMBER_OF_TERMS 4000000
+#define NUMBER_OF_LOOKUPS 2000000
+#define DEFAULT_LEXICON_PATH "/tmp/lexicon-benchmark.bin"
+
+/**
+ * Generate the i-th synthetic word, words with the same index but another prefix are never in the lexicon
+ * The index is scrambled by a bijection of the 64 bit integers, an odd multiplication and a xorshift,
+ * so two indexes never give the same word
+ * @param prefix The prefix of the word
+ * @param i The index of the word
+ * @return The generated word
+ */
+static char * generateTerm(char * prefix, uint64_t i) {
+    uint64_t scrambled = i * 0x9E3779B97F4A7C15ULL;
+    scrambled ^= scrambled >> 32;
+
+    char term[64];
+    snprintf(term, sizeof(term), "%s%lx", prefix, (unsigned long)scrambled);
+
+    return strdup(term);
+}
+
+/**
+ * Look up a set of words and print the average latency
+ * @param lexicon The lexicon to look into
+ * @param label The label of the measurement
+ * @param terms The words to look up
+ * @param numberOfLookups The number of words
+ */
+static void measureLookups(struct Lexicon * lexicon, char * label, char ** terms, int numberOfLookups) {
+    struct PostingLocation location;
+    int found = 0;
+
+    int64_t start = getCurrentTimestamp();
+    for (int i = 0; i < numberOfLookups; i++) {
+        found += lookupTerm(lexicon, terms[i], &location);
+    }
+    int64_t elapsed = getCurrentTimestamp() - start;
+
+    printf("%-6s %d lookups, %d found, %.1f ns per lookup\n", label, numberOfLookups, found,
+           elapsed * 1000.0 / numberOfLookups);
+}
+
+int main(int argc, char ** argv) {
+    uint64_t numberOfTerms = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_NUMBER_OF_TERMS;
+    char * path = argc > 2 ? argv[2] : DEFAULT_LEXICON_PATH;
+
+    char ** terms = (char **)malloc(numberOfTerms * sizeof(char *));
+    struct PostingLocation * locations = (struct PostingLocation *)malloc(numberOfTerms * sizeof(struct PostingLocation));
+
+    for (uint64_t i = 0; i < numberOfTerms; i++) {
+        terms[i] = generateTerm("w", i);
+        locations[i].segment = (uint32_t)(i % 16);
+        locations[i].offset = i * 32;
+        locations[i].length = 32;
+    }
+
+    int64_t start = getCurrentTimestamp();
+    if (!buildLexicon(path, terms, locations, numberOfTerms)) {
+        return 1;
+    }
+    printf("Built a lexicon of %lu words in %.2f s\n", (unsigned long)numberOfTerms, (getCurrentTimestamp() - start) / 1e6);
+
+    struct Lexicon * lexicon = openLexicon(path);
+    if (!lexicon) {
+        printf("Could not open %s\n", path);
+        return 1;
+    }
+    printf("Lexicon size: %.2f bytes per word\n", (double)lexicon->size / (double)(numberOfTerms ? numberOfTerms : 1));
+
+    // Random order, so that the lookups do not walk the table sequentially
+    char ** hits = (char **)malloc(NUMBER_OF_LOOKUPS * sizeof(char *));
+    char ** misses = (char **)malloc(NUMBER_OF_LOOKUPS * sizeof(char *));
+    srand(42);
+    for (int i = 0; i < NUMBER_OF_LOOKUPS && numberOfTerms > 0; i++) {
+        hits[i] = terms[((uint64_t)rand() * RAND_MAX + rand()) % numberOfTerms];
+        misses[i] = generateTerm("x", (uint64_t)rand());
+    }
+
+    if (numberOfTerms > 0) {
+        measureLookups(lexicon, "hit", hits, NUMBER_OF_LOOKUPS);
+        measureLookups(lexicon, "miss", misses, NUMBER_OF_LOOKUPS);
+
+        // Every word is checked once, to validate the perfect hash
+        struct PostingLocation location;
+        uint64_t wrong = 0;
+        for (uint64_t i = 0; i < numberOfTerms; i++) {
+            if (!lookupTerm(lexicon, terms[i], &location) || location.offset != i * 32) {
+                wrong++;
+            }
+        }
+        printf("Wrong lookups: %lu\n", (unsigned long)wrong);
+    }
+
+    closeLexicon(lexicon);
+    if (argc <= 2) {
+        remove(path);
+    }
+
+    return 0;
+}
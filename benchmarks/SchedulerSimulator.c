@@ -0,0 +1,800 @@
+/**
+ * Discrete-event simulator of the master scheduler, driven by a task trace recorded with --trace, or a synthetic one
+ *
+ * The input files go through the same state machine as in the master, see MapReduceOperation.c, and the final phase
+ * replays the recorded reduce tasks once all the files are done. Every task takes as long as it took in the trace.
+ * The master handles one message at a time, every completion and every dispatch costs it the dispatch latency,
+ * which models the message rate of rank 0. A task is a straggler once it ran for longer than the speculation factor
+ * times the median duration of its stage, without knowing when it ends, and the idle workers are checked for copies
+ * both on every completion and whenever a running task becomes a straggler. Since a trace cannot tell a slow task from
+ * a slow worker, its copy runs for a duration drawn from the recorded durations of the stage, the copy and the original
+ * race, and the first one to finish cancels the other.
+ *
+ * Usage: SchedulerSimulator [trace] [--synthetic={files}] [--ranks={n}] [--policy=fifo|shortest|longest]
+ *                           [--batch={tasks}] [--dispatch-latency={us}] [--speculate={factor}] [--seed={seed}]
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include "../defs/MapReduceOperation.h"
+#include "../defs/TaskTrace.h"
+
+#define DEFAULT_NUMBER_OF_RANKS 8
+#define DEFAULT_DISPATCH_LATENCY 20
+#define DEFAULT_SEED 42
+
+// The stages of an input file, followed by the final phase
+#define NUMBER_OF_STAGES 4
+#define REDUCE_STAGE 3
+
+// Policies for the order of the available tasks
+enum SchedulingPolicy {
+    FifoPolicy,
+    ShortestFirstPolicy,
+    LongestFirstPolicy
+};
+
+/**
+ * Struct to hold the durations of the three stages of an input file, and when its first stage was sent
+ */
+struct SimulatedFile {
+    char * name;
+    int64_t durations[REDUCE_STAGE];
+    int64_t firstStart;
+};
+
+/**
+ * Struct to hold the task a worker runs, the operation of its file or the group of reduce tasks,
+ * When it started and ends, and the worker running the other copy of a speculated task, or -1
+ */
+struct SimulatedTask {
+    bool running;
+    int stage;
+    int item;
+    int64_t start;
+    int64_t end;
+    bool speculative;
+    int twin;
+};
+
+/**
+ * Struct to hold the options of a simulation
+ */
+struct SimulationOptions {
+    int numberOfRanks;
+    enum SchedulingPolicy policy;
+    int batch;
+    int64_t dispatchLatency;
+    double speculationFactor;
+};
+
+/**
+ * Struct to hold the state of a simulation: the operations of the input files and the heap of the available ones,
+ * The groups of reduce tasks, the sorted durations and the median of every stage, by group for the final phase, the generator of the copies,
+ * The task of every worker, the clock of the master and the counters of the run
+ */
+struct Simulation {
+    struct SimulationOptions options;
+
+    struct SimulatedFile * files;
+    struct Operation * operations;
+    int numberOfFiles;
+    int * availableOperations;
+    int numberOfAvailableOperations;
+
+    int64_t * reduceGroups;
+    int numberOfReduceGroups;
+    int nextReduceGroup;
+
+    int64_t * stageDurations[NUMBER_OF_STAGES];
+    int numberOfStageDurations[NUMBER_OF_STAGES];
+    int64_t medians[NUMBER_OF_STAGES];
+    unsigned int seed;
+
+    struct SimulatedTask * workers;
+    int64_t masterClock;
+    int64_t masterBusy;
+    int64_t busyTime;
+    int64_t wastedTime;
+    int phase;
+    int64_t phaseEnd;
+
+    long speculativeCopies;
+    long speculativeWins;
+};
+
+/**
+ * Get the stage of a task from its name in a trace
+ * @param stage The name of the stage, see getTaskName
+ * @return The stage, or -1 for the tasks that are not simulated
+ */
+static int getStageIndex(char * stage) {
+    if (strcmp(stage, getTaskName(TASK_PROCESS_WORDS)) == 0) { return 0; }
+    if (strcmp(stage, getTaskName(TASK_INDEX_FILE)) == 0) { return 1; }
+    if (strcmp(stage, getTaskName(TASK_REVERSE_INDEX_FILE)) == 0) { return 2; }
+    if (strcmp(stage, getTaskName(TASK_REVERSE_INDEX_WORD)) == 0 ||
+        strcmp(stage, getTaskName(TASK_REVERSE_INDEX_PART)) == 0 ||
+        strcmp(stage, getTaskName(TASK_REVERSE_INDEX_MERGE)) == 0 ||
+        strcmp(stage, getTaskName(TASK_JOB_REDUCE)) == 0) {
+        return REDUCE_STAGE;
+    }
+
+    return -1;
+}
+
+/**
+ * Get the stage of the next task of a file, from the last operation done on it
+ * @param lastOperation The last operation done on the file
+ * @return The stage
+ */
+static int getNextStage(enum OperationTag lastOperation) {
+    switch (getNextTaskForTag(lastOperation)) {
+        case TASK_INDEX_FILE:
+            return 1;
+        case TASK_REVERSE_INDEX_FILE:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Comparator used to sort durations in increasing order
+ * @param a The first duration
+ * @param b The second duration
+ * @return The order of the two durations
+ */
+static int compareDurations(const void * a, const void * b) {
+    int64_t first = *(const int64_t *)a;
+    int64_t second = *(const int64_t *)b;
+
+    return (first > second) - (first < second);
+}
+
+/**
+ * Comparator used to sort trace records by name
+ * @param a The first record
+ * @param b The second record
+ * @return The order of the two records
+ */
+static int compareRecordNames(const void * a, const void * b) {
+    return strcmp((*(struct TaskTraceRecord * const *)a)->name, (*(struct TaskTraceRecord * const *)b)->name);
+}
+
+/**
+ * Comparator used to sort the files in the order their first stage was sent
+ * @param a The first file
+ * @param b The second file
+ * @return The order of the two files
+ */
+static int compareFileStarts(const void * a, const void * b) {
+    int64_t first = ((const struct SimulatedFile *)a)->firstStart;
+    int64_t second = ((const struct SimulatedFile *)b)->firstStart;
+
+    return (first > second) - (first < second);
+}
+
+/**
+ * Draw a uniform number in (0, 1]
+ * @param seed The state of the generator
+ * @return The number
+ */
+static double drawUniform(unsigned int * seed) {
+    return (rand_r(seed) + 1.0) / ((double)RAND_MAX + 1.0);
+}
+
+/**
+ * Generate the trace of a run on input files with a heavy tailed size distribution,
+ * With about 40 distinct words per file for the final phase, and a few slow reduce tasks
+ * @param numberOfFiles The number of input files
+ * @param seed The seed of the generator
+ * @param records Where the records are stored, see freeTaskTrace
+ * @return The number of records
+ */
+static int generateSyntheticTrace(int numberOfFiles, unsigned int seed, struct TaskTraceRecord ** records) {
+    int numberOfWords = numberOfFiles * 40;
+    int numberOfRecords = numberOfFiles * REDUCE_STAGE + numberOfWords;
+    *records = (struct TaskTraceRecord *)calloc(numberOfRecords + 1, sizeof(struct TaskTraceRecord));
+
+    char * stages[REDUCE_STAGE] = { getTaskName(TASK_PROCESS_WORDS), getTaskName(TASK_INDEX_FILE),
+                                    getTaskName(TASK_REVERSE_INDEX_FILE) };
+    // Microseconds per byte of every stage, the map stage creates a file per word
+    double costs[REDUCE_STAGE] = { 0.8, 0.3, 0.4 };
+
+    int r = 0;
+    for (int i = 0; i < numberOfFiles; i++) {
+        double size = fmin(4096.0 / pow(drawUniform(&seed), 0.8), 64.0 * 1024 * 1024);
+        char name[32];
+        snprintf(name, sizeof(name), "file-%d.txt", i);
+
+        for (int s = 0; s < REDUCE_STAGE; s++, r++) {
+            snprintf((*records)[r].stage, MAX_TRACE_STAGE_LENGTH, "%s", stages[s]);
+            (*records)[r].start = i;
+            (*records)[r].end = i + 20 + (int64_t)(size * costs[s]);
+            (*records)[r].bytesRead = (long)size;
+            (*records)[r].name = strdup(name);
+        }
+    }
+
+    for (int i = 0; i < numberOfWords; i++, r++) {
+        double duration = -150.0 * log(drawUniform(&seed));
+        if (drawUniform(&seed) < 0.01) {
+            duration *= 20;
+        }
+
+        snprintf((*records)[r].stage, MAX_TRACE_STAGE_LENGTH, "%s", getTaskName(TASK_REVERSE_INDEX_WORD));
+        (*records)[r].end = 10 + (int64_t)duration;
+        (*records)[r].name = strdup("");
+    }
+
+    return numberOfRecords;
+}
+
+/**
+ * Check whether an available operation goes before another one by the policy of the simulation,
+ * the ties are broken like getNextOperation, by the order of the files
+ * @param simulation The simulation
+ * @param first The index of the file of the first operation
+ * @param second The index of the file of the second operation
+ * @return True or false, whether the first operation goes first
+ */
+static bool isOperationBefore(struct Simulation * simulation, int first, int second) {
+    if (simulation->options.policy != FifoPolicy) {
+        int64_t firstDuration = simulation->files[first].durations[getNextStage(simulation->operations[first].lastOperation)];
+        int64_t secondDuration = simulation->files[second].durations[getNextStage(simulation->operations[second].lastOperation)];
+
+        if (firstDuration != secondDuration) {
+            return simulation->options.policy == ShortestFirstPolicy ? firstDuration < secondDuration :
+                                                                        firstDuration > secondDuration;
+        }
+    }
+
+    return first < second;
+}
+
+/**
+ * Add an operation that became available to the heap of the available operations
+ * @param simulation The simulation
+ * @param item The index of the file of the operation
+ */
+static void pushAvailableOperation(struct Simulation * simulation, int item) {
+    int * heap = simulation->availableOperations;
+    int child = simulation->numberOfAvailableOperations++;
+
+    while (child > 0 && isOperationBefore(simulation, item, heap[(child - 1) / 2])) {
+        heap[child] = heap[(child - 1) / 2];
+        child = (child - 1) / 2;
+    }
+    heap[child] = item;
+}
+
+/**
+ * Pick the next operation of an input file for an idle worker, by the policy of the simulation
+ * The available operations are kept in a heap, so that a pick does not scan all the files
+ * @param simulation The simulation
+ * @return The index of the file of the operation, or -1 if none is available
+ */
+static int pickOperation(struct Simulation * simulation) {
+    if (simulation->numberOfAvailableOperations == 0) {
+        return -1;
+    }
+
+    int * heap = simulation->availableOperations;
+    int picked = heap[0];
+    int last = heap[--simulation->numberOfAvailableOperations];
+
+    int parent = 0;
+    while (2 * parent + 1 < simulation->numberOfAvailableOperations) {
+        int child = 2 * parent + 1;
+        if (child + 1 < simulation->numberOfAvailableOperations && isOperationBefore(simulation, heap[child + 1], heap[child])) {
+            child++;
+        }
+        if (!isOperationBefore(simulation, heap[child], last)) {
+            break;
+        }
+
+        heap[parent] = heap[child];
+        parent = child;
+    }
+    heap[parent] = last;
+
+    return picked;
+}
+
+/**
+ * Keep the sorted durations of a stage and their median
+ * @param simulation The simulation
+ * @param stage The stage
+ * @param durations The durations, allocated with malloc, owned by the simulation afterwards
+ * @param numberOfDurations The number of durations
+ */
+static void setStageDurations(struct Simulation * simulation, int stage, int64_t * durations, int numberOfDurations) {
+    qsort(durations, numberOfDurations, sizeof(int64_t), compareDurations);
+
+    simulation->stageDurations[stage] = durations;
+    simulation->numberOfStageDurations[stage] = numberOfDurations;
+    simulation->medians[stage] = numberOfDurations > 0 ? durations[numberOfDurations / 2] : 0;
+}
+
+/**
+ * Draw the duration of a speculative copy from the recorded durations of its stage
+ * @param simulation The simulation
+ * @param stage The stage of the copy
+ * @return The duration
+ */
+static int64_t drawStageDuration(struct Simulation * simulation, int stage) {
+    if (simulation->numberOfStageDurations[stage] == 0) {
+        return 0;
+    }
+
+    return simulation->stageDurations[stage][rand_r(&simulation->seed) % simulation->numberOfStageDurations[stage]];
+}
+
+/**
+ * Build the files, the reduce groups and the median durations of a simulation from the records of a trace
+ * @param simulation The simulation
+ * @param records The records
+ * @param numberOfRecords The number of records
+ */
+static void loadSimulation(struct Simulation * simulation, struct TaskTraceRecord * records, int numberOfRecords) {
+    struct TaskTraceRecord ** fileRecords = (struct TaskTraceRecord **)malloc((numberOfRecords + 1) * sizeof(struct TaskTraceRecord *));
+    int64_t * reduceDurations = (int64_t *)malloc((numberOfRecords + 1) * sizeof(int64_t));
+    int64_t * stageDurations[REDUCE_STAGE];
+    int numberOfStageDurations[REDUCE_STAGE] = { 0 };
+    int numberOfFileRecords = 0;
+    int numberOfReduceTasks = 0;
+
+    for (int s = 0; s < REDUCE_STAGE; s++) {
+        stageDurations[s] = (int64_t *)malloc((numberOfRecords + 1) * sizeof(int64_t));
+    }
+
+    for (int i = 0; i < numberOfRecords; i++) {
+        int stage = getStageIndex(records[i].stage);
+        if (stage == -1) {
+            continue;
+        }
+
+        int64_t duration = records[i].end > records[i].start ? records[i].end - records[i].start : 0;
+
+        if (stage == REDUCE_STAGE) {
+            reduceDurations[numberOfReduceTasks++] = duration;
+        } else {
+            stageDurations[stage][numberOfStageDurations[stage]++] = duration;
+            fileRecords[numberOfFileRecords++] = records + i;
+        }
+    }
+
+    for (int s = 0; s < REDUCE_STAGE; s++) {
+        setStageDurations(simulation, s, stageDurations[s], numberOfStageDurations[s]);
+    }
+
+    // The records of a file are consecutive once sorted by name, a stage missing from the trace takes the median
+    qsort(fileRecords, numberOfFileRecords, sizeof(struct TaskTraceRecord *), compareRecordNames);
+    simulation->files = (struct SimulatedFile *)malloc((numberOfFileRecords + 1) * sizeof(struct SimulatedFile));
+    simulation->numberOfFiles = 0;
+
+    for (int i = 0; i < numberOfFileRecords; i++) {
+        struct SimulatedFile * file = simulation->files + simulation->numberOfFiles - 1;
+
+        if (simulation->numberOfFiles == 0 || strcmp(file->name, fileRecords[i]->name) != 0) {
+            file = simulation->files + simulation->numberOfFiles++;
+            file->name = fileRecords[i]->name;
+            file->firstStart = fileRecords[i]->start;
+            for (int s = 0; s < REDUCE_STAGE; s++) {
+                file->durations[s] = -1;
+            }
+        }
+
+        int stage = getStageIndex(fileRecords[i]->stage);
+        file->durations[stage] = fileRecords[i]->end - fileRecords[i]->start;
+        if (fileRecords[i]->start < file->firstStart) {
+            file->firstStart = fileRecords[i]->start;
+        }
+    }
+
+    qsort(simulation->files, simulation->numberOfFiles, sizeof(struct SimulatedFile), compareFileStarts);
+
+    simulation->operations = (struct Operation *)malloc((simulation->numberOfFiles + 1) * sizeof(struct Operation));
+    for (int i = 0; i < simulation->numberOfFiles; i++) {
+        for (int s = 0; s < REDUCE_STAGE; s++) {
+            if (simulation->files[i].durations[s] < 0) {
+                simulation->files[i].durations[s] = simulation->medians[s];
+            }
+        }
+
+        simulation->operations[i].filename = simulation->files[i].name;
+        simulation->operations[i].currentOperation = simulation->operations[i].lastOperation = Available;
+        simulation->operations[i].mapRank = 0;
+    }
+
+    simulation->availableOperations = (int *)malloc((simulation->numberOfFiles + 1) * sizeof(int));
+    simulation->numberOfAvailableOperations = 0;
+    for (int i = 0; i < simulation->numberOfFiles; i++) {
+        pushAvailableOperation(simulation, i);
+    }
+
+    // The reduce tasks are sent in groups of the batch size, ordered by the policy
+    if (simulation->options.policy != FifoPolicy) {
+        qsort(reduceDurations, numberOfReduceTasks, sizeof(int64_t), compareDurations);
+    }
+    if (simulation->options.policy == LongestFirstPolicy) {
+        for (int i = 0; i < numberOfReduceTasks / 2; i++) {
+            int64_t swap = reduceDurations[i];
+            reduceDurations[i] = reduceDurations[numberOfReduceTasks - 1 - i];
+            reduceDurations[numberOfReduceTasks - 1 - i] = swap;
+        }
+    }
+
+    int batch = simulation->options.batch;
+    simulation->numberOfReduceGroups = (numberOfReduceTasks + batch - 1) / batch;
+    simulation->reduceGroups = (int64_t *)calloc(simulation->numberOfReduceGroups + 1, sizeof(int64_t));
+    for (int i = 0; i < numberOfReduceTasks; i++) {
+        simulation->reduceGroups[i / batch] += reduceDurations[i];
+    }
+
+    // A task of the final phase is a whole group, so its stragglers are found among the groups
+    int64_t * groupDurations = (int64_t *)malloc((simulation->numberOfReduceGroups + 1) * sizeof(int64_t));
+    memcpy(groupDurations, simulation->reduceGroups, simulation->numberOfReduceGroups * sizeof(int64_t));
+    setStageDurations(simulation, REDUCE_STAGE, groupDurations, simulation->numberOfReduceGroups);
+
+    free(fileRecords);
+    free(reduceDurations);
+}
+
+/**
+ * Start a task on a worker, the master spends the dispatch latency sending it
+ * @param simulation The simulation
+ * @param worker The worker
+ * @param stage The stage of the task
+ * @param item The file or the reduce group of the task
+ * @param duration How long the task runs
+ */
+static void startTask(struct Simulation * simulation, int worker, int stage, int item, int64_t duration) {
+    simulation->masterClock += simulation->options.dispatchLatency;
+    simulation->masterBusy += simulation->options.dispatchLatency;
+
+    struct SimulatedTask * task = simulation->workers + worker;
+    task->running = true;
+    task->stage = stage;
+    task->item = item;
+    task->start = simulation->masterClock;
+    task->end = simulation->masterClock + duration;
+    task->speculative = false;
+    task->twin = -1;
+}
+
+/**
+ * Get the time a task becomes a straggler, once it ran for longer than the speculation factor times the median of
+ * its stage
+ * @param simulation The simulation
+ * @param task The task
+ * @return The time
+ */
+static int64_t getStragglerTime(struct Simulation * simulation, struct SimulatedTask * task) {
+    return task->start + (int64_t)(simulation->options.speculationFactor * simulation->medians[task->stage]) + 1;
+}
+
+/**
+ * Start a copy of the longest running straggler on an idle worker, when speculation is enabled
+ * Like the master, the simulation only knows when a task started and not when it ends,
+ * a task whose report already reached the master is not a straggler any more
+ * @param simulation The simulation
+ * @param worker The idle worker
+ * @return True or false, whether a copy was started
+ */
+static bool speculateTask(struct Simulation * simulation, int worker) {
+    if (simulation->options.speculationFactor <= 0) {
+        return false;
+    }
+
+    int straggler = -1;
+    for (int w = 1; w < simulation->options.numberOfRanks; w++) {
+        struct SimulatedTask * task = simulation->workers + w;
+
+        if (!task->running || task->speculative || task->twin != -1 || task->end <= simulation->masterClock ||
+            simulation->masterClock < getStragglerTime(simulation, task)) {
+            continue;
+        }
+
+        if (straggler == -1 || task->start < simulation->workers[straggler].start) {
+            straggler = w;
+        }
+    }
+
+    if (straggler == -1) {
+        return false;
+    }
+
+    struct SimulatedTask * original = simulation->workers + straggler;
+    startTask(simulation, worker, original->stage, original->item, drawStageDuration(simulation, original->stage));
+    simulation->workers[worker].speculative = true;
+    simulation->workers[worker].twin = straggler;
+    original->twin = worker;
+    simulation->speculativeCopies++;
+
+    return true;
+}
+
+/**
+ * Hand out the available tasks to the idle workers
+ * @param simulation The simulation
+ */
+static void dispatchTasks(struct Simulation * simulation) {
+    for (int worker = 1; worker < simulation->options.numberOfRanks; worker++) {
+        if (simulation->workers[worker].running) {
+            continue;
+        }
+
+        if (simulation->phase == 1) {
+            int item = pickOperation(simulation);
+            if (item != -1) {
+                int stage = getNextStage(simulation->operations[item].lastOperation);
+
+                simulation->operations[item].currentOperation = InProgress;
+                startTask(simulation, worker, stage, item, simulation->files[item].durations[stage]);
+                continue;
+            }
+        } else if (simulation->nextReduceGroup < simulation->numberOfReduceGroups) {
+            int item = simulation->nextReduceGroup++;
+            startTask(simulation, worker, REDUCE_STAGE, item, simulation->reduceGroups[item]);
+            continue;
+        }
+
+        speculateTask(simulation, worker);
+    }
+}
+
+/**
+ * Complete the task of a worker, and cancel its other copy
+ * @param simulation The simulation
+ * @param worker The worker
+ */
+static void completeTask(struct Simulation * simulation, int worker) {
+    struct SimulatedTask * task = simulation->workers + worker;
+    task->running = false;
+    simulation->busyTime += task->end - task->start;
+
+    if (task->twin != -1) {
+        struct SimulatedTask * twin = simulation->workers + task->twin;
+        twin->running = false;
+        twin->twin = -1;
+        simulation->busyTime += task->end - twin->start;
+        simulation->wastedTime += task->end - twin->start;
+
+        if (task->speculative) {
+            simulation->speculativeWins++;
+        }
+    }
+
+    // The master receives the report before the next dispatch
+    simulation->masterClock = (simulation->masterClock > task->end ? simulation->masterClock : task->end) +
+                              simulation->options.dispatchLatency;
+    simulation->masterBusy += simulation->options.dispatchLatency;
+
+    if (task->stage == REDUCE_STAGE) {
+        return;
+    }
+
+    // The operation of the file is known from the task, so its state is changed in place instead of by name
+    struct Operation * operation = simulation->operations + task->item;
+
+    switch (task->stage) {
+        case 0:
+            operation->currentOperation = Available;
+            operation->lastOperation = GetWords;
+            break;
+        case 1:
+            operation->currentOperation = Available;
+            operation->lastOperation = DirectIndex;
+            break;
+        default:
+            operation->currentOperation = Done;
+            operation->lastOperation = Done;
+    }
+
+    if (operation->currentOperation == Available) {
+        pushAvailableOperation(simulation, task->item);
+    }
+}
+
+/**
+ * Get the next time a running task becomes a straggler while a worker is idle to run its copy,
+ * the master then checks the idle workers again, like on a completion
+ * @param simulation The simulation
+ * @return The time, or -1 when no copy can be started before the next completion
+ */
+static int64_t getNextStragglerTime(struct Simulation * simulation) {
+    if (simulation->options.speculationFactor <= 0) {
+        return -1;
+    }
+
+    bool idleWorker = false;
+    for (int w = 1; w < simulation->options.numberOfRanks; w++) {
+        idleWorker = idleWorker || !simulation->workers[w].running;
+    }
+    if (!idleWorker) {
+        return -1;
+    }
+
+    int64_t next = -1;
+    for (int w = 1; w < simulation->options.numberOfRanks; w++) {
+        struct SimulatedTask * task = simulation->workers + w;
+        if (!task->running || task->speculative || task->twin != -1) {
+            continue;
+        }
+
+        // The tasks that were stragglers at the last check did not find an idle worker then
+        int64_t stragglerTime = getStragglerTime(simulation, task);
+        if (stragglerTime > simulation->masterClock && (next == -1 || stragglerTime < next)) {
+            next = stragglerTime;
+        }
+    }
+
+    return next;
+}
+
+/**
+ * Run a simulation until all the tasks of both phases are done
+ * @param simulation The simulation
+ * @return The makespan, in microseconds
+ */
+static int64_t runSimulation(struct Simulation * simulation) {
+    int64_t lastEnd = 0;
+
+    simulation->phase = 1;
+    dispatchTasks(simulation);
+
+    while (true) {
+        int next = -1;
+        for (int w = 1; w < simulation->options.numberOfRanks; w++) {
+            if (simulation->workers[w].running && (next == -1 || simulation->workers[w].end < simulation->workers[next].end)) {
+                next = w;
+            }
+        }
+
+        // A task that becomes a straggler before the next completion can be copied by an idle worker right away
+        int64_t stragglerTime = getNextStragglerTime(simulation);
+        if (stragglerTime != -1 && next != -1 && stragglerTime < simulation->workers[next].end) {
+            simulation->masterClock = stragglerTime;
+            dispatchTasks(simulation);
+            continue;
+        }
+
+        if (next == -1) {
+            // The final phase starts once no file has an operation left
+            if (simulation->phase == 1) {
+                simulation->phase = 2;
+                simulation->phaseEnd = lastEnd;
+                dispatchTasks(simulation);
+                continue;
+            }
+            break;
+        }
+
+        lastEnd = simulation->workers[next].end;
+        completeTask(simulation, next);
+        dispatchTasks(simulation);
+    }
+
+    if (simulation->phase == 1) {
+        simulation->phaseEnd = lastEnd;
+    }
+
+    return lastEnd > simulation->masterClock ? lastEnd : simulation->masterClock;
+}
+
+/**
+ * Get a readable name for a policy
+ * @param policy The policy
+ * @return The name of the policy
+ */
+static char * getPolicyName(enum SchedulingPolicy policy) {
+    switch (policy) {
+        case ShortestFirstPolicy:
+            return "shortest";
+        case LongestFirstPolicy:
+            return "longest";
+        default:
+            return "fifo";
+    }
+}
+
+int main(int argc, char ** argv) {
+    struct Simulation simulation;
+    memset(&simulation, 0, sizeof(simulation));
+    simulation.options.numberOfRanks = DEFAULT_NUMBER_OF_RANKS;
+    simulation.options.policy = FifoPolicy;
+    simulation.options.batch = 1;
+    simulation.options.dispatchLatency = DEFAULT_DISPATCH_LATENCY;
+
+    char * tracePath = NULL;
+    int syntheticFiles = 0;
+    unsigned int seed = DEFAULT_SEED;
+    simulation.seed = DEFAULT_SEED;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--ranks=", 8) == 0) {
+            simulation.options.numberOfRanks = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--policy=", 9) == 0) {
+            char * policy = argv[i] + 9;
+            simulation.options.policy = strcmp(policy, "shortest") == 0 ? ShortestFirstPolicy :
+                                        strcmp(policy, "longest") == 0 ? LongestFirstPolicy : FifoPolicy;
+        } else if (strncmp(argv[i], "--batch=", 8) == 0) {
+            simulation.options.batch = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--dispatch-latency=", 19) == 0) {
+            simulation.options.dispatchLatency = atol(argv[i] + 19);
+        } else if (strncmp(argv[i], "--speculate=", 12) == 0) {
+            simulation.options.speculationFactor = atof(argv[i] + 12);
+        } else if (strncmp(argv[i], "--synthetic=", 12) == 0) {
+            syntheticFiles = atoi(argv[i] + 12);
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            seed = (unsigned int)strtoul(argv[i] + 7, NULL, 10);
+            simulation.seed = seed;
+        } else if (argv[i][0] != '-') {
+            tracePath = argv[i];
+        } else {
+            printf("Ignoring unknown option %s\n", argv[i]);
+        }
+    }
+
+    if (simulation.options.numberOfRanks < 2 || simulation.options.batch < 1 || (!tracePath && syntheticFiles <= 0)) {
+        printf("Usage: %s [trace] [--synthetic={files}] [--ranks={n}] [--policy=fifo|shortest|longest]\n"
+               "       [--batch={tasks}] [--dispatch-latency={us}] [--speculate={factor}] [--seed={seed}]\n", argv[0]);
+        return 1;
+    }
+
+    struct TaskTraceRecord * records;
+    int numberOfRecords = tracePath ? readTaskTrace(tracePath, &records) : generateSyntheticTrace(syntheticFiles, seed, &records);
+    if (numberOfRecords < 0) {
+        return 1;
+    }
+
+    int64_t recordedMakespan = 0;
+    for (int i = 0; i < numberOfRecords; i++) {
+        if (records[i].end > recordedMakespan) {
+            recordedMakespan = records[i].end;
+        }
+    }
+
+    loadSimulation(&simulation, records, numberOfRecords);
+    simulation.workers = (struct SimulatedTask *)calloc(simulation.options.numberOfRanks, sizeof(struct SimulatedTask));
+
+    int64_t makespan = runSimulation(&simulation);
+    int numberOfWorkers = simulation.options.numberOfRanks - 1;
+
+    printf("Simulated %d files and %d reduce groups on %d ranks, policy %s, batch %d, dispatch latency %lld us\n",
+           simulation.numberOfFiles, simulation.numberOfReduceGroups, simulation.options.numberOfRanks,
+           getPolicyName(simulation.options.policy), simulation.options.batch, (long long)simulation.options.dispatchLatency);
+    if (tracePath) {
+        printf("Recorded makespan:    %.3f s\n", recordedMakespan / 1e6);
+    }
+    printf("Phase 1 makespan:     %.3f s\n", simulation.phaseEnd / 1e6);
+    printf("Phase 2 makespan:     %.3f s\n", (makespan - simulation.phaseEnd) / 1e6);
+    printf("Predicted makespan:   %.3f s\n", makespan / 1e6);
+    printf("Worker utilization:   %.1f%% (%.1f%% without cancelled copies)\n",
+           makespan > 0 ? 100.0 * simulation.busyTime / ((double)numberOfWorkers * makespan) : 0.0,
+           makespan > 0 ? 100.0 * (simulation.busyTime - simulation.wastedTime) / ((double)numberOfWorkers * makespan) : 0.0);
+    printf("Master utilization:   %.1f%%\n", makespan > 0 ? 100.0 * simulation.masterBusy / makespan : 0.0);
+    if (simulation.options.speculationFactor > 0) {
+        printf("Speculative copies:   %ld, %ld finished first\n", simulation.speculativeCopies, simulation.speculativeWins);
+    }
+
+    free(simulation.workers);
+    free(simulation.operations);
+    free(simulation.availableOperations);
+    free(simulation.files);
+    free(simulation.reduceGroups);
+    for (int s = 0; s < NUMBER_OF_STAGES; s++) {
+        free(simulation.stageDurations[s]);
+    }
+    freeTaskTrace(records, numberOfRecords);
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * Header library for a bump allocator whose allocations are all released at once,
+ * used to scope the allocations of a worker to the task it is executing
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_ARENA_H
+#define MAPREDUCE_V2_ARENA_H
+
+#include <stddef.h>
+
+// The size of the first block of an arena
+#define DEFAULT_ARENA_BLOCK_SIZE 65536
+
+/**
+ * A block of memory that allocations are carved from, blocks are chained from the newest to the oldest
+ */
+struct ArenaBlock {
+    struct ArenaBlock * previous;
+    size_t size;
+    size_t used;
+    char data[];
+};
+
+/**
+ * Struct to hold the blocks of an arena,
+ * The number of bytes in use and the maximum since the last reset,
+ * And the number of allocations since the last reset
+ */
+struct Arena {
+    struct ArenaBlock * current;
+    size_t blockSize;
+    size_t usedBytes;
+    size_t peakBytes;
+    long numberOfAllocations;
+};
+
+/**
+ * A position in an arena, everything allocated after it can be released with releaseArena
+ */
+struct ArenaMark {
+    struct ArenaBlock * block;
+    size_t used;
+    size_t usedBytes;
+};
+
+void initArena(struct Arena * arena, size_t blockSize);
+
+void * arenaAllocate(struct Arena * arena, size_t size);
+
+char * arenaDuplicate(struct Arena * arena, const char * string);
+
+struct ArenaMark markArena(struct Arena * arena);
+
+void releaseArena(struct Arena * arena, struct ArenaMark mark);
+
+void resetArena(struct Arena * arena);
+
+void freeArena(struct Arena * arena);
+
+#endif
@@ -0,0 +1,15 @@
+/**
+ * Header library for the jobs that ship with the MapReduce algorithm
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_BUILTINJOBS_H
+#define MAPREDUCE_V2_BUILTINJOBS_H
+
+#include <stdbool.h>
+
+bool registerBuiltinJobs(char * jobNames);
+
+#endif
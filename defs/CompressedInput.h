@@ -0,0 +1,43 @@
+/**
+ * Header library used for reading gzip and zstd compressed input files as plain text streams
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_COMPRESSEDINPUT_H
+#define MAPREDUCE_V2_COMPRESSEDINPUT_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/**
+ * The compression formats that are recognised by their magic bytes
+ */
+enum InputCompression {
+    NoCompression,
+    GzipCompression,
+    ZstdCompression
+};
+
+/**
+ * Struct to hold the format of an input file,
+ * The number of bytes read from the disk and handed to the tokenizer,
+ * And the time spent decompressing, in microseconds
+ */
+struct InputStatistics {
+    enum InputCompression compression;
+    int64_t compressedBytes;
+    int64_t decompressedBytes;
+    int64_t decompressionTime;
+};
+
+FILE * openInputFile(char * path, struct InputStatistics * statistics);
+
+const char * getCompressionName(enum InputCompression compression);
+
+void addInputStatistics(struct InputStatistics * totals, struct InputStatistics * statistics);
+
+double getDecompressionThroughput(struct InputStatistics * statistics);
+
+#endif
@@ -8,10 +8,8 @@
 #ifndef MAPREDUCE_V2_DIRECTORYFILES_H
 #define MAPREDUCE_V2_DIRECTORYFILES_H
 
-#include <dirent.h>
-
 struct DirectoryFiles {
-    struct dirent ** filenames;
+    char ** filenames;
     int numberOfFiles;
 };
 
@@ -0,0 +1,46 @@
+/**
+ * Header library for a streaming directory enumerator that yields entries in unsorted batches
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_DIRECTORYSTREAM_H
+#define MAPREDUCE_V2_DIRECTORYSTREAM_H
+
+#include <stdbool.h>
+#include "../defs/Arena.h"
+
+// Default number of entries handed out by a single batch
+#define DIRECTORY_BATCH_SIZE 256
+
+/**
+ * An open directory that is being enumerated, one getdents64 buffer per level
+ */
+struct DirectoryStreamLevel {
+    int fd;
+    char * relativePath;
+    char * buffer;
+    int bufferPosition;
+    int bufferLength;
+};
+
+/**
+ * Struct to hold the state of a directory enumeration,
+ * Whether subdirectories are descended into,
+ * And the stack of directories that are currently open
+ */
+struct DirectoryStream {
+    bool recursive;
+    struct DirectoryStreamLevel * levels;
+    int depth;
+    int capacity;
+};
+
+struct DirectoryStream * openDirectoryStream(char * directoryName, bool recursive);
+
+int readDirectoryBatch(struct DirectoryStream * stream, char ** names, int maxNames, struct Arena * arena);
+
+void closeDirectoryStream(struct DirectoryStream * stream);
+
+#endif
@@ -8,13 +8,27 @@
 #ifndef MAPREDUCE_V2_FILEOPERATIONS_H
 #define MAPREDUCE_V2_FILEOPERATIONS_H
 
+#include <stdio.h>
 #include "../defs/DirectoryFiles.h"
+#include "../defs/Arena.h"
 
-struct DirectoryFiles getFileNamesForDirectory(char * directoryName);
+// The maximum number of characters of a word, longer words are truncated
+#define MAX_WORD_LENGTH 254
 
-char * buildFilePath(char * directoryName, char * fileName);
+// Character that replaces '/' when a nested input path is stored as a single file name
+#define FLATTENED_PATH_SEPARATOR ':'
 
-char * readWord(FILE * file);
+struct DirectoryFiles getFileNamesForDirectory(char * directoryName, struct Arena * arena);
+
+void freeDirectoryFiles(struct DirectoryFiles * df);
+
+char * flattenFilePath(char * relativePath, struct Arena * arena);
+
+char * restoreFilePath(char * flattened);
+
+char * buildFilePath(char * directoryName, char * fileName, struct Arena * arena);
+
+char * readWord(FILE * file, struct Arena * arena);
 
 FILE * createFile(char * filename);
 
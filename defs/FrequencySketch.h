@@ -0,0 +1,49 @@
+/**
+ * Header library for a Count-Min sketch that estimates the frequencies of words in a fixed amount of memory,
+ * with the Count-Mean-Min estimate that stays accurate when there are more distinct words than counters
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_FREQUENCYSKETCH_H
+#define MAPREDUCE_V2_FREQUENCYSKETCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// The number of independent rows of a sketch, the estimate is the median over the rows
+#define FREQUENCY_SKETCH_DEPTH 4
+// The largest number of rows of a sketch that is read from a file
+#define MAX_FREQUENCY_SKETCH_DEPTH 16
+// The number of counters of a row, a power of two
+#define FREQUENCY_SKETCH_WIDTH 8192
+
+/**
+ * Struct to hold the counters of a sketch, depth rows of width counters each,
+ * And the sum of all the amounts that were added to it
+ */
+struct FrequencySketch {
+    int depth;
+    int width;
+    long total;
+    uint32_t * counters;
+};
+
+void initFrequencySketch(struct FrequencySketch * sketch, int depth, int width);
+
+void addToFrequencySketch(struct FrequencySketch * sketch, const char * word, uint32_t amount);
+
+long estimateFrequency(struct FrequencySketch * sketch, const char * word);
+
+bool mergeFrequencySketch(struct FrequencySketch * sketch, struct FrequencySketch * other);
+
+bool writeFrequencySketch(struct FrequencySketch * sketch, char * path);
+
+bool readFrequencySketch(struct FrequencySketch * sketch, char * path);
+
+bool loadFrequencySketches(char * directoryName, struct FrequencySketch * sketch);
+
+void freeFrequencySketch(struct FrequencySketch * sketch);
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ * Header library for the lexicon of the reverse index: an mmap-able minimal perfect hash from every word
+ * to the location of its postings, guarded by a Bloom filter that rejects absent words without touching the table
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_LEXICON_H
+#define MAPREDUCE_V2_LEXICON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LEXICON_MAGIC "ALPDLEX2"
+
+/**
+ * The location of the postings of a word: the segment (the rank that wrote them),
+ * and the offset and the length within the postings of the segment
+ */
+struct PostingLocation {
+    uint64_t offset;
+    uint32_t length;
+    uint32_t segment;
+};
+
+/**
+ * The header at the beginning of a lexicon file, all the offsets are relative to the beginning of the file
+ */
+struct LexiconHeader {
+    char magic[8];
+    uint64_t numberOfTerms;
+    uint64_t numberOfBuckets;
+    uint64_t seed;
+    uint64_t bloomBits;
+    uint64_t bloomHashes;
+    uint64_t bloomOffset;
+    uint64_t pilotsOffset;
+    uint64_t slotsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsLength;
+};
+
+/**
+ * A slot of the minimal perfect hash table, holding the word it was built for and its posting location
+ */
+struct LexiconSlot {
+    uint64_t termOffset;
+    struct PostingLocation location;
+};
+
+/**
+ * An open lexicon, mapped in memory
+ */
+struct Lexicon {
+    void * map;
+    size_t size;
+    const struct LexiconHeader * header;
+    const uint64_t * bloom;
+    const int32_t * pilots;
+    const struct LexiconSlot * slots;
+    const char * strings;
+};
+
+bool buildLexicon(char * path, char ** terms, struct PostingLocation * locations, uint64_t numberOfTerms);
+
+struct Lexicon * openLexicon(char * path);
+
+bool lookupTerm(struct Lexicon * lexicon, const char * term, struct PostingLocation * location);
+
+void closeLexicon(struct Lexicon * lexicon);
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * Header library for the posting segments that the reduce stage writes for the lexicon, one per worker
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_LEXICONSEGMENTS_H
+#define MAPREDUCE_V2_LEXICONSEGMENTS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../defs/Lexicon.h"
+
+/**
+ * The segment written by one worker: the postings of every word it reduced, one after the other,
+ * The location of the postings of every word, and the length of the postings written so far
+ */
+struct LexiconSegment {
+    FILE * postings;
+    FILE * terms;
+    uint64_t postingsLength;
+};
+
+/**
+ * Struct to hold the segments a reader of the lexicon opened, by segment number, -1 for the ones not opened yet
+ */
+struct SegmentReader {
+    char * segmentsDirectory;
+    int * descriptors;
+    uint32_t numberOfDescriptors;
+};
+
+bool openLexiconSegment(char * segmentsDirectory, int rank, struct LexiconSegment * segment);
+
+bool appendToLexiconSegment(struct LexiconSegment * segment, char * term, char * postings, size_t length);
+
+void closeLexiconSegment(struct LexiconSegment * segment);
+
+bool buildLexiconFromSegments(char * segmentsDirectory, char * lexiconPath);
+
+void openSegmentReader(struct SegmentReader * reader, char * segmentsDirectory);
+
+char * readPostings(struct SegmentReader * reader, struct PostingLocation * location);
+
+void closeSegmentReader(struct SegmentReader * reader);
+
+#endif
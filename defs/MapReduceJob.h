@@ -0,0 +1,57 @@
+/**
+ * Header library for the pluggable jobs that are fed from the tokenization pass of the map stage
+ *
+ * Every registered job sees all the words of every input file, emits key/value pairs when a file ends,
+ * and gets its pairs shuffled on its own channel directory, so N analyses cost a single scan of the input
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_MAPREDUCEJOB_H
+#define MAPREDUCE_V2_MAPREDUCEJOB_H
+
+#include <stdbool.h>
+
+#define MAX_MAP_REDUCE_JOBS 16
+
+/**
+ * Function used by a job to emit a key/value pair, the key must be a valid file name
+ */
+typedef void (*EmitFunction)(void * emitContext, char * key, long value);
+
+/**
+ * Function pointer table of a job
+ * beginFile creates the per-file state, mapWord is called for every word of the file in order,
+ * endFile emits the pairs of the file and frees the state,
+ * reduce folds all the values emitted for a key, starting from 0
+ */
+struct MapReduceJob {
+    char * name;
+    void * (*beginFile)(char * fileName);
+    void (*mapWord)(void * state, char * word);
+    void (*endFile)(void * state, EmitFunction emit, void * emitContext);
+    long (*reduce)(long accumulated, long value);
+};
+
+/**
+ * The destination of the pairs emitted by a job for one input file
+ */
+struct JobChannel {
+    char * directory;
+    char * fileName;
+};
+
+bool registerMapReduceJob(struct MapReduceJob * job);
+
+int getNumberOfMapReduceJobs(void);
+
+struct MapReduceJob * getMapReduceJob(int index);
+
+struct MapReduceJob * findMapReduceJob(char * name);
+
+void emitToJobChannel(void * emitContext, char * key, long value);
+
+bool reduceJobKey(struct MapReduceJob * job, char * channelDirectory, char * key, char * outputDirectory);
+
+#endif
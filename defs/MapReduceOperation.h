@@ -28,8 +28,15 @@ enum OperationTag {
 #define TASK_PROCESS_WORDS 103
 #define TASK_REVERSE_INDEX_FILE 104
 #define TASK_REVERSE_INDEX_WORD 105
+#define TASK_JOB_REDUCE 106
+#define TASK_FLUSH_SKETCH 107
+#define TASK_REVERSE_INDEX_PART 108
+#define TASK_REVERSE_INDEX_MERGE 109
 #define TASK_KILL 999
 
+// The largest task message, the final stage sends batches of words separated by new lines
+#define MAX_TASK_MESSAGE_SIZE 65536
+
 /**
  * Struct to hold the name of the file that is processed,
  * The node that did the last processing,
@@ -39,20 +46,30 @@ struct Operation {
     char * filename;
     enum OperationTag lastOperation;
     enum OperationTag currentOperation;
+    // The worker whose shared segment holds the words of the file, only readable from its node, or 0 when they are in files
+    int mapRank;
 };
 
 bool doableOperations(struct Operation * operations, int numberOfOperations);
 
 struct Operation * getNextOperation(struct Operation * operations, int numberOfOperations);
 
+struct Operation * getNextOperationForWorker(struct Operation * operations, int numberOfOperations, int worker,
+                                             int * nodeOfRank);
+
 void changeOperationCurrentStatusByName(struct Operation *operations, int numberOfOperations, char *operationName,
                                         enum OperationTag currentStatus);
 
 void changeOperationLastStatusByName(struct Operation *operations, int numberOfOperations, char *operationName,
                                         enum OperationTag lastStatus);
 
+void changeOperationMapRankByName(struct Operation *operations, int numberOfOperations, char *operationName,
+                                  int mapRank);
+
 int getNextTaskForTag(enum OperationTag lastTag);
 
 int getAvailableWorkerId(bool workers[], int numberOfWorkers);
 
+char * getTaskName(int tag);
+
 #endif
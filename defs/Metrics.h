@@ -0,0 +1,101 @@
+/**
+ * Header library for the live metrics of the master, exported in the Prometheus text format
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_METRICS_H
+#define MAPREDUCE_V2_METRICS_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "../defs/MapReduceOperation.h"
+#include "../defs/Arena.h"
+
+// Microseconds between two rewrites of the metrics textfile
+#define METRICS_EXPORT_INTERVAL 1000000
+// Microseconds between two checks of the metrics socket for waiting clients
+#define METRICS_POLL_INTERVAL 50000
+// Milliseconds a client of the metrics socket gets to take the whole response, so a stalled client cannot hold the master
+#define METRICS_SEND_TIMEOUT 200
+// The number of task types that are counted, see getMetricsTaskIndex
+#define NUMBER_OF_METRICS_TASKS 7
+// The number of per-file stages of the operations table, and their states that are counted
+#define NUMBER_OF_METRICS_STAGES 3
+#define NUMBER_OF_METRICS_STATES 2
+
+/**
+ * The number of bytes a process moved through read and write system calls
+ */
+struct IoCounters {
+    long bytesRead;
+    long bytesWritten;
+};
+
+/**
+ * Struct to hold the completed tasks and the bytes moved by a worker,
+ * The allocations of its tasks and the largest peak size of the arena of a task,
+ * The time it spent on its tasks, as seen by the master,
+ * And when its current task was sent, 0 when it has none
+ */
+struct RankMetrics {
+    long tasksCompleted;
+    long bytesRead;
+    long bytesWritten;
+    long arenaAllocations;
+    long peakArenaBytes;
+    int64_t busyTime;
+    int64_t dispatchTime;
+};
+
+/**
+ * Struct to hold the counters of the master,
+ * The number of input files by stage and state, as last seen in the operations table,
+ * The targets the metrics are exported to, and the trace of the completed tasks,
+ * And when they were last exported
+ */
+struct Metrics {
+    int numberOfRanks;
+    struct RankMetrics * ranks;
+
+    long tasksDispatched[NUMBER_OF_METRICS_TASKS];
+    long tasksCompleted[NUMBER_OF_METRICS_TASKS];
+    long tasksInFlight;
+    long queueDepth;
+    int phase;
+
+    long files[NUMBER_OF_METRICS_STAGES][NUMBER_OF_METRICS_STATES];
+    long filesDone;
+    long filesDiscovered;
+
+    char * textfilePath;
+    char * socketPath;
+    int listenSocket;
+    FILE * trace;
+
+    int64_t startTime;
+    int64_t lastExport;
+    int64_t lastPoll;
+};
+
+bool readIoCounters(struct IoCounters * counters);
+
+int formatTaskReport(char * buffer, int size, char * taskName, struct IoCounters * taskStart, struct Arena * taskArena);
+
+void initMetrics(struct Metrics * metrics, int numberOfRanks, char * textfilePath, char * socketPath, char * tracePath);
+
+void recordTaskDispatched(struct Metrics * metrics, int rank, int tag);
+
+void recordTaskCompleted(struct Metrics * metrics, int rank, int tag, char * message, int messageLength);
+
+void updateMetrics(struct Metrics * metrics, int phase, struct Operation * operations, int numberOfOperations, long queuedTasks);
+
+void pollMetrics(struct Metrics * metrics, int phase, struct Operation * operations, int numberOfOperations, long queuedTasks);
+
+void exportMetrics(struct Metrics * metrics);
+
+void freeMetrics(struct Metrics * metrics);
+
+#endif
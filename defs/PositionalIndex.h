@@ -0,0 +1,53 @@
+/**
+ * Header library for the positional reverse index, which stores the token offsets of every word
+ * as delta and varint compressed position lists, so phrase queries do not have to read the input files
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_POSITIONALINDEX_H
+#define MAPREDUCE_V2_POSITIONALINDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// The maximum number of bytes a varint encoded 32 bit value takes
+#define MAX_VARINT_BYTES 5
+
+/**
+ * The positions of a word inside one file, in increasing order
+ */
+struct Posting {
+    char * fileName;
+    int numberOfPositions;
+    uint32_t * positions;
+};
+
+/**
+ * All the postings of a word
+ */
+struct PostingList {
+    struct Posting * postings;
+    int numberOfPostings;
+};
+
+size_t encodeVarint(uint32_t value, unsigned char * buffer);
+
+size_t decodeVarint(const unsigned char * buffer, size_t length, uint32_t * value);
+
+size_t encodePositions(const uint32_t * positions, int numberOfPositions, unsigned char * buffer);
+
+int decodePositions(const unsigned char * buffer, size_t length, uint32_t * positions, int maxPositions);
+
+bool writePostingRecord(FILE * file, char * fileName, int numberOfPositions, const unsigned char * encoded, size_t length);
+
+bool readPostingList(char * indexDirectory, char * word, struct PostingList * list);
+
+void freePostingList(struct PostingList * list);
+
+int findPhrase(char * indexDirectory, char ** words, int numberOfWords, char *** matchingFiles);
+
+#endif
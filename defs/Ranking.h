@@ -0,0 +1,35 @@
+/**
+ * Header library used for precomputing the TF-IDF weights of the reverse index postings
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_RANKING_H
+#define MAPREDUCE_V2_RANKING_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "../defs/WordCounter.h"
+
+// The number of postings written in the top block when no other value is given
+#define DEFAULT_TOP_POSTINGS 10
+
+/**
+ * A posting of the reverse index together with its TF-IDF weight
+ */
+struct WeightedPosting {
+    char * fileName;
+    long count;
+    double weight;
+};
+
+bool loadDocumentLengths(char * directoryName, struct WordCounter * documentLengths);
+
+double computeInverseDocumentFrequency(long numberOfDocuments, long documentFrequency);
+
+int selectTopPostings(struct WeightedPosting * postings, int numberOfPostings, int k, struct WeightedPosting * top);
+
+void writeRankedPostings(FILE * file, struct WeightedPosting * postings, int numberOfPostings, int k, double idf);
+
+#endif
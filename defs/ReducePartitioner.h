@@ -0,0 +1,92 @@
+/**
+ * Header library used for grouping the words of the final reverse index stage into tasks of similar cost
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_REDUCEPARTITIONER_H
+#define MAPREDUCE_V2_REDUCEPARTITIONER_H
+
+#include <stdbool.h>
+#include "../defs/FrequencySketch.h"
+
+// The number of reduce tasks every worker should get, when the volume of a task is computed automatically
+#define REDUCE_TASKS_PER_WORKER 16
+// The smallest volume of a task computed automatically, so that small inputs do not get split
+#define MIN_REDUCE_VOLUME 64
+// The largest number of parts a single word is split into
+#define MAX_REDUCE_PARTS 64
+// Separates a split word from its part in the messages of the part and merge tasks
+#define REDUCE_PART_SEPARATOR '\t'
+
+/**
+ * A task of the final stage, the tag and the message that are sent to the worker
+ */
+struct ReduceTask {
+    int tag;
+    char * message;
+};
+
+/**
+ * A word that was split across several workers, and the number of parts that are not reverse-indexed yet
+ */
+struct SplitWord {
+    char * word;
+    int numberOfParts;
+    int remainingParts;
+};
+
+/**
+ * Struct to hold the sketch that estimates the number of postings of every word,
+ * The posting volume a task should have and the number of parts a word can be split into,
+ * The batch of words that is being filled,
+ * The queue of tasks that are ready to be sent,
+ * And the split words whose parts are not all reverse-indexed yet
+ */
+struct ReducePartitioner {
+    struct FrequencySketch * sketch;
+    long targetVolume;
+    int maxParts;
+
+    char * batch;
+    int batchLength;
+    long batchVolume;
+
+    struct ReduceTask * tasks;
+    int firstTask;
+    int numberOfTasks;
+    int tasksCapacity;
+
+    struct SplitWord * splitWords;
+    int numberOfSplitWords;
+    int splitWordsCapacity;
+
+    int totalBatches;
+    int totalSplitWords;
+};
+
+void initReducePartitioner(struct ReducePartitioner * partitioner, struct FrequencySketch * sketch,
+                           int numberOfWorkers, long targetVolume);
+
+void queueReduceTask(struct ReducePartitioner * partitioner, int tag, char * message);
+
+void addReduceWord(struct ReducePartitioner * partitioner, char * word);
+
+void flushReduceBatch(struct ReducePartitioner * partitioner);
+
+bool hasReduceTasks(struct ReducePartitioner * partitioner);
+
+int getNumberOfQueuedReduceTasks(struct ReducePartitioner * partitioner);
+
+bool getNextReduceTask(struct ReducePartitioner * partitioner, struct ReduceTask * task);
+
+bool formatReducePartName(char * buffer, char * word, int part, bool positions);
+
+bool parseReducePart(char * message, char * word, int * part, int * numberOfParts);
+
+bool completeReducePart(struct ReducePartitioner * partitioner, char * message);
+
+void freeReducePartitioner(struct ReducePartitioner * partitioner);
+
+#endif
@@ -0,0 +1,37 @@
+/**
+ * Header library used for parsing the command line options of a MapReduce run
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_RUNOPTIONS_H
+#define MAPREDUCE_V2_RUNOPTIONS_H
+
+#include <stdbool.h>
+
+/**
+ * Struct to hold the optional behaviours of a run, all of them are disabled by default,
+ * And whether the workers measure the bytes of every task, which only the metrics and the trace use
+ */
+struct RunOptions {
+    bool recursiveInput;
+    char * jobs;
+    bool positionalIndex;
+    bool rankedIndex;
+    int topPostings;
+    bool buildLexicon;
+    bool balanceReduce;
+    long reduceVolume;
+    char * metricsFile;
+    char * metricsSocket;
+    bool sharedShuffle;
+    long sharedSegmentMegabytes;
+    bool distributedScheduling;
+    char * tracePath;
+    bool countTaskIo;
+};
+
+struct RunOptions parseRunOptions(int argc, char ** argv);
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * Header library for handing the map output of a file to the ranks of the same node through shared memory
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_SHAREDSHUFFLE_H
+#define MAPREDUCE_V2_SHAREDSHUFFLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <mpi.h>
+
+// The size of the shared segment of every worker when no other size is given, in megabytes
+#define DEFAULT_SHARED_SEGMENT_MEGABYTES 64
+
+// The last string of the report of a map task whose words are in the segment of its worker
+#define SHARED_OUTPUT_MARKER "shared"
+
+/**
+ * The start of the segment of every worker, the records are appended after it
+ */
+struct SharedSegmentHeader {
+    uint64_t used;
+    uint64_t numberOfRecords;
+};
+
+/**
+ * The map output of a file, followed by the name of the file and its words, all terminated by '\0',
+ * The position of a word is its index in the record
+ */
+struct SharedRecordHeader {
+    uint32_t consumed;
+    uint32_t nameLength;
+    uint32_t numberOfWords;
+    uint32_t padding;
+    uint64_t dataLength;
+};
+
+/**
+ * Struct to hold the communicator of the ranks of the current node and their shared window,
+ * The segment of every rank of the node,
+ * The node of every rank, identified by the lowest rank running on it, and the rank it has on its node,
+ * And the record the current rank is writing
+ */
+struct SharedShuffle {
+    bool enabled;
+    MPI_Comm nodeComm;
+    int nodeRank;
+    int nodeSize;
+    MPI_Win window;
+    char ** segments;
+    size_t * segmentSizes;
+    int * nodeOfRank;
+    int * nodeRankOfRank;
+
+    size_t recordStart;
+    size_t recordCursor;
+    uint32_t recordWords;
+    bool recordOpen;
+};
+
+void initSharedShuffle(struct SharedShuffle * shuffle, bool requested, size_t segmentSize, bool isWorker);
+
+bool beginMapOutput(struct SharedShuffle * shuffle, char * name, size_t maximumLength);
+
+bool appendMapOutput(struct SharedShuffle * shuffle, char * word);
+
+void commitMapOutput(struct SharedShuffle * shuffle);
+
+char * abandonMapOutput(struct SharedShuffle * shuffle, uint32_t * numberOfWords);
+
+struct SharedRecordHeader * findMapOutput(struct SharedShuffle * shuffle, char * name, int producerRank);
+
+char * getMapOutputWords(struct SharedRecordHeader * record);
+
+void releaseMapOutput(struct SharedShuffle * shuffle, struct SharedRecordHeader * record);
+
+int appendSharedOutputMarker(char * report, int reportLength, int size);
+
+bool hasSharedOutputMarker(char * report, int reportLength);
+
+void freeSharedShuffle(struct SharedShuffle * shuffle);
+
+#endif
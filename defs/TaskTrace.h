@@ -0,0 +1,43 @@
+/**
+ * Header library for the traces of the tasks of a run, recorded by the master and replayed by the scheduler simulator
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_TASKTRACE_H
+#define MAPREDUCE_V2_TASKTRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// The longest stage name of a trace record
+#define MAX_TRACE_STAGE_LENGTH 32
+
+/**
+ * Struct to hold a task of a trace: its stage, see getTaskName, the worker that ran it,
+ * When it was sent and reported, in microseconds since the start of the run,
+ * The bytes it read and wrote, the allocations and the peak size of its arena,
+ * And its name, empty for the tasks reported without a name
+ */
+struct TaskTraceRecord {
+    char stage[MAX_TRACE_STAGE_LENGTH];
+    int rank;
+    int64_t start;
+    int64_t end;
+    long bytesRead;
+    long bytesWritten;
+    long arenaAllocations;
+    long arenaPeakBytes;
+    char * name;
+};
+
+FILE * openTaskTrace(char * path);
+
+void writeTaskTraceRecord(FILE * trace, struct TaskTraceRecord * record);
+
+int readTaskTrace(char * path, struct TaskTraceRecord ** records);
+
+void freeTaskTrace(struct TaskTraceRecord * records, int numberOfRecords);
+
+#endif
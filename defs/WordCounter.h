@@ -0,0 +1,40 @@
+/**
+ * Header library for a hash table that counts the appearances of words
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_WORDCOUNTER_H
+#define MAPREDUCE_V2_WORDCOUNTER_H
+
+#include <stdint.h>
+
+/**
+ * A counted word, entries with a NULL word are empty slots
+ */
+struct WordCount {
+    char * word;
+    long count;
+};
+
+/**
+ * Open addressing hash table that maps words to their number of appearances
+ */
+struct WordCounter {
+    struct WordCount * entries;
+    int capacity;
+    int size;
+};
+
+uint64_t hashWord(const char * word, uint64_t seed);
+
+void initWordCounter(struct WordCounter * counter, int initialCapacity);
+
+long incrementWord(struct WordCounter * counter, char * word, long amount);
+
+long getWordCount(struct WordCounter * counter, char * word);
+
+void freeWordCounter(struct WordCounter * counter);
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * Header library for the distributed scheduling of a phase, by work stealing between all the ranks
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#ifndef MAPREDUCE_V2_WORKSTEALING_H
+#define MAPREDUCE_V2_WORKSTEALING_H
+
+#include <stdbool.h>
+#include <mpi.h>
+
+// Tags of the messages of a phase, exchanged on a communicator of their own
+#define STEAL_REQUEST 201
+#define STEAL_REPLY 202
+#define STEAL_TOKEN 203
+#define STEAL_PHASE_DONE 204
+
+// The colors of the ranks and of the termination token
+#define TOKEN_WHITE 0
+#define TOKEN_BLACK 1
+
+/**
+ * Struct to hold the tasks of a rank, the indexes of the tasks of the phase, taken from the front and stolen from the back,
+ * The victim of the pending steal request and the number of consecutive empty replies,
+ * The state of the rank for the termination detection: its message counter, its color and the token when it holds it,
+ * And the number of steals
+ */
+struct WorkStealer {
+    MPI_Comm comm;
+    int rank;
+    int numberOfRanks;
+
+    int * tasks;
+    int first;
+    int last;
+
+    int pendingVictim;
+    int nextVictim;
+    int emptyReplies;
+    bool quiescent;
+    unsigned int seed;
+
+    long messageCounter;
+    int color;
+    bool holdsToken;
+    long tokenCount;
+    int tokenColor;
+    bool done;
+
+    long tasksStolen;
+    long stealRequests;
+};
+
+void initWorkStealer(struct WorkStealer * stealer, int numberOfTasks);
+
+int getNextStolenTask(struct WorkStealer * stealer);
+
+void freeWorkStealer(struct WorkStealer * stealer);
+
+#endif
@@ -23,6 +23,7 @@
  * @date 01.12.2017
  */
 
+#include <limits.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -32,6 +33,20 @@
 
 #include "defs/ErrorHandling.h"
 #include "defs/FileOperations.h"
+#include "defs/DirectoryStream.h"
+#include "defs/Arena.h"
+#include "defs/RunOptions.h"
+#include "defs/MapReduceJob.h"
+#include "defs/BuiltinJobs.h"
+#include "defs/PositionalIndex.h"
+#include "defs/Ranking.h"
+#include "defs/CompressedInput.h"
+#include "defs/LexiconSegments.h"
+#include "defs/FrequencySketch.h"
+#include "defs/ReducePartitioner.h"
+#include "defs/Metrics.h"
+#include "defs/SharedShuffle.h"
+#include "defs/WorkStealing.h"
 #include "defs/Utils.h"
 #include "defs/MapReduceOperation.h"
 #include "defs/Logging.h"
@@ -41,6 +56,1315 @@
 #define DIRECT_INDEX_LOCATION "/mnt/alpd/direct-index"
 #define REVERSE_INDEX_TEMP_LOCATION "/mnt/alpd/reverse-index-temporary"
 #define REVERSE_INDEX_LOCATION "/mnt/alpd/reverse-index"
+#define DIRECT_INDEX_POSITIONS_LOCATION "/mnt/alpd/direct-index-positions"
+#define REVERSE_INDEX_POSITIONS_LOCATION "/mnt/alpd/reverse-index-positions"
+#define DOCUMENT_LENGTHS_LOCATION "/mnt/alpd/document-lengths"
+#define LEXICON_SEGMENTS_LOCATION "/mnt/alpd/lexicon-segments"
+#define LEXICON_LOCATION "/mnt/alpd/lexicon"
+#define JOBS_LOCATION "/mnt/alpd/jobs"
+#define JOBS_OUTPUT_LOCATION "/mnt/alpd/jobs-output"
+#define SKETCHES_LOCATION "/mnt/alpd/sketches"
+#define REVERSE_INDEX_PARTS_LOCATION "/mnt/alpd/reverse-index-parts"
+
+/**
+ * Comparator used to sort the positions of a word in increasing order
+ * @param a The first position
+ * @param b The second position
+ * @return The order of the two positions
+ */
+static int comparePositions(const void * a, const void * b) {
+    uint32_t first = *(const uint32_t *)a;
+    uint32_t second = *(const uint32_t *)b;
+
+    return (first > second) - (first < second);
+}
+
+/**
+ * An occurrence of a word in the map output of a file
+ */
+struct MapOutputEntry {
+    char * word;
+    uint32_t position;
+};
+
+/**
+ * Comparator used to sort the map output of a file by word and position,
+ * The words are ordered as the "{word}_{timestamp}" files of the temporary directory are
+ * @param a The first entry
+ * @param b The second entry
+ * @return The order of the two entries
+ */
+static int compareMapOutputEntries(const void * a, const void * b) {
+    const struct MapOutputEntry * first = (const struct MapOutputEntry *)a;
+    const struct MapOutputEntry * second = (const struct MapOutputEntry *)b;
+    const unsigned char * firstWord = (const unsigned char *)first->word;
+    const unsigned char * secondWord = (const unsigned char *)second->word;
+
+    while (*firstWord && *firstWord == *secondWord) {
+        firstWord++;
+        secondWord++;
+    }
+
+    // The end of a word sorts as the '_' that follows it in the file name
+    int firstCharacter = *firstWord ? *firstWord : '_';
+    int secondCharacter = *secondWord ? *secondWord : '_';
+    if (firstCharacter != secondCharacter) {
+        return firstCharacter - secondCharacter;
+    }
+
+    return (first->position > second->position) - (first->position < second->position);
+}
+
+/**
+ * Write a word of a file to the temporary directory, as a file "{word}_{timestamp}",
+ * Or "{word}_{timestamp}_{position}" when the positions of the words are indexed
+ * @param tempDirName The temporary directory of the file
+ * @param word The word
+ * @param position The position of the word in the file
+ * @param positional Whether the position is part of the name
+ * @param arena The arena of the task
+ */
+static void writeMapOutputFile(char * tempDirName, char * word, int position, bool positional, struct Arena * arena) {
+    FILE * written = NULL;
+    char fileToWrite[FILENAME_MAX];
+
+    // For loop used to try to write the file to the disk.
+    // Creation of the file might fail if the timestamp is the previous one
+    // This is a safety measure, even if the chances of that happening are slim
+    for (int i = 0; i < 5; i++) {
+        if (positional) {
+            sprintf(fileToWrite, "%s_%ld_%d", word, getCurrentTimestamp(), position);
+        } else {
+            sprintf(fileToWrite, "%s_%ld", word, getCurrentTimestamp());
+        }
+
+        written = createFile(buildFilePath(tempDirName, fileToWrite, arena));
+
+        if (written != NULL) {
+            break;
+        }
+    }
+
+    if (written != NULL) {
+        fclose(written);
+    }
+}
+
+/**
+ * Comparator used to sort names alphabetically
+ * @param a The first name
+ * @param b The second name
+ * @return The order of the two names
+ */
+static int compareNames(const void * a, const void * b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/**
+ * Comparator used to sort postings by file name, in the order of the "{fileName}_{count}_{timestamp}" files
+ * of the temporary reverse index, so that the merged parts of a word are ordered as a single task orders them
+ * @param a The first posting
+ * @param b The second posting
+ * @return The order of the two postings
+ */
+static int comparePostingNames(const void * a, const void * b) {
+    const unsigned char * firstName = (const unsigned char *)((const struct WeightedPosting *)a)->fileName;
+    const unsigned char * secondName = (const unsigned char *)((const struct WeightedPosting *)b)->fileName;
+
+    while (*firstName && *firstName == *secondName) {
+        firstName++;
+        secondName++;
+    }
+
+    // The end of a name sorts as the '_' that follows it in the file name
+    int firstCharacter = *firstName ? *firstName : '_';
+    int secondCharacter = *secondName ? *secondName : '_';
+
+    return firstCharacter - secondCharacter;
+}
+
+/**
+ * List the postings of a part of a split word, the ones whose name hashes to the part
+ * The directory is streamed, only the names of the part are kept and sorted, so every part costs a read
+ * of the directory entries instead of a sorted listing of all the postings of the word
+ * @param wordPath The temporary reverse index directory of the word
+ * @param part The part to list
+ * @param numberOfParts The number of parts
+ * @param names Where the names are stored, allocated from the arena
+ * @param arena The arena of the task
+ * @return The number of names of the part
+ */
+static int listPostingsPart(char * wordPath, int part, int numberOfParts, char *** names, struct Arena * arena) {
+    int numberOfNames = 0;
+    int capacity = 0;
+    *names = NULL;
+
+    struct DirectoryStream * stream = openDirectoryStream(wordPath, false);
+    if (!stream) {
+        return 0;
+    }
+
+    char * batch[DIRECTORY_BATCH_SIZE];
+    int numberOfRead;
+    while ((numberOfRead = readDirectoryBatch(stream, batch, DIRECTORY_BATCH_SIZE, NULL)) > 0) {
+        for (int i = 0; i < numberOfRead; i++) {
+            if (hashWord(batch[i], 0) % (uint64_t)numberOfParts == (uint64_t)part) {
+                if (numberOfNames == capacity) {
+                    char ** previousNames = *names;
+                    capacity = capacity ? capacity * 2 : 256;
+                    *names = (char **)arenaAllocate(arena, capacity * sizeof(char *));
+                    if (previousNames) {
+                        memcpy(*names, previousNames, numberOfNames * sizeof(char *));
+                    }
+                }
+
+                (*names)[numberOfNames++] = arenaDuplicate(arena, batch[i]);
+            }
+
+            free(batch[i]);
+        }
+    }
+    closeDirectoryStream(stream);
+
+    qsort(*names, numberOfNames, sizeof(char *), compareNames);
+    return numberOfNames;
+}
+
+/**
+ * Read the postings of a word from the temporary reverse index, or a part of them
+ * @param word The word
+ * @param part The part to read
+ * @param numberOfParts The number of parts the postings are divided into by the hash of their names, 1 to read all of them
+ * @param positionsFile The file where the positions records of the postings are written, or NULL
+ * @param postings Where the postings are stored, with the flattened file names, allocated from the arena
+ * @param arena The arena of the task
+ * @return The number of postings read
+ */
+static int collectPostings(char * word, int part, int numberOfParts, FILE * positionsFile,
+                           struct WeightedPosting ** postings, struct Arena * arena) {
+    char * wordPath = buildFilePath(REVERSE_INDEX_TEMP_LOCATION, word, arena);
+    char ** names;
+    int numberOfNames;
+
+    // The parts of a split word are not contiguous ranges, which would need the whole sorted listing in every part
+    if (numberOfParts > 1) {
+        numberOfNames = listPostingsPart(wordPath, part, numberOfParts, &names, arena);
+    } else {
+        struct DirectoryFiles df = getFileNamesForDirectory(wordPath, arena);
+        names = df.filenames;
+        numberOfNames = df.numberOfFiles;
+    }
+
+    *postings = (struct WeightedPosting *)arenaAllocate(arena, (numberOfNames + 1) * sizeof(struct WeightedPosting));
+
+    for (int i = 0; i < numberOfNames; i++) {
+        struct WeightedPosting * posting = *postings + i;
+
+        // The path of the posting file is built before its name is split
+        char * postingPath = positionsFile ? buildFilePath(wordPath, names[i], arena) : NULL;
+
+        posting->fileName = strtok(names[i], "_");
+        char * numberOfApparitions = strtok(NULL, "_");
+        posting->count = numberOfApparitions ? atol(numberOfApparitions) : 0;
+        posting->weight = 0.0;
+
+        FILE * postingFile = postingPath ? fopen(postingPath, "rb") : NULL;
+        if (postingFile) {
+            fseek(postingFile, 0, SEEK_END);
+            size_t encodedLength = (size_t)ftell(postingFile);
+            rewind(postingFile);
+
+            unsigned char * encoded = (unsigned char *)arenaAllocate(arena, encodedLength + 1);
+            encodedLength = fread(encoded, 1, encodedLength, postingFile);
+            fclose(postingFile);
+
+            // The positions files name the input files by their path, like the final reverse index
+            char * filePath = restoreFilePath(arenaDuplicate(arena, posting->fileName));
+            writePostingRecord(positionsFile, filePath, (int)posting->count, encoded, encodedLength);
+        }
+    }
+
+    return numberOfNames;
+}
+
+/**
+ * Format the final postings of a word, once for its reverse index file and its lexicon segment
+ * @param postings The postings of the word, with the flattened file names, which are restored in place
+ * @param numberOfPostings The number of postings
+ * @param options The options of the run
+ * @param documentLengths The number of words of every file, when the postings are ranked
+ * @param length Where the length of the formatted postings is stored
+ * @return The formatted postings, which must be freed by the caller, or NULL in case they could not be formatted
+ */
+static char * formatReverseIndexWord(struct WeightedPosting * postings, int numberOfPostings, struct RunOptions * options,
+                                     struct WordCounter * documentLengths, size_t * length) {
+    char * text = NULL;
+    FILE * wordFile = open_memstream(&text, length);
+    if (!wordFile) {
+        return NULL;
+    }
+
+    if (options->rankedIndex) {
+        double idf = computeInverseDocumentFrequency(documentLengths->size, numberOfPostings);
+
+        for (int i = 0; i < numberOfPostings; i++) {
+            // The term frequency is normalized by the number of words of the file
+            long documentLength = getWordCount(documentLengths, postings[i].fileName);
+
+            postings[i].weight = documentLength > 0 ? (double)postings[i].count / documentLength * idf : 0.0;
+            restoreFilePath(postings[i].fileName);
+        }
+
+        writeRankedPostings(wordFile, postings, numberOfPostings, options->topPostings, idf);
+    } else {
+        for (int i = 0; i < numberOfPostings; i++) {
+            fprintf(wordFile, "%s %ld\n", restoreFilePath(postings[i].fileName), postings[i].count);
+        }
+    }
+
+    if (fclose(wordFile) != 0) {
+        free(text);
+        return NULL;
+    }
+
+    return text;
+}
+
+/**
+ * Write the final reverse index file of a word
+ * @param word The word
+ * @param postings The formatted postings of the word, see formatReverseIndexWord
+ * @param length The length of the postings
+ * @param arena The arena of the task
+ * @return True or false, whether the file could be written
+ */
+static bool writeReverseIndexWord(char * word, char * postings, size_t length, struct Arena * arena) {
+    FILE * wordFile = fopen(buildFilePath(REVERSE_INDEX_LOCATION, word, arena), "a");
+    if (!wordFile) {
+        return false;
+    }
+
+    bool written = fwrite(postings, 1, length, wordFile) == length;
+    return fclose(wordFile) == 0 && written;
+}
+
+/**
+ * Struct to hold the state a worker keeps between its tasks,
+ * The arena of the current task, with the allocations of all the tasks and the largest peak size of the arena,
+ * The document lengths and the lexicon segment, loaded on the first final reverse index task,
+ * The frequency sketch of the distinct words of the direct-indexed files,
+ * The decompression totals of the compressed input files it mapped,
+ * And whether the completed tasks are reported to the master
+ */
+struct WorkerState {
+    int rank;
+    struct RunOptions * options;
+    struct SharedShuffle * shuffle;
+
+    struct Arena taskArena;
+    long numberOfArenaAllocations;
+    size_t peakArenaBytes;
+    struct WordCounter documentLengths;
+    bool documentLengthsLoaded;
+    struct LexiconSegment lexiconSegment;
+    struct FrequencySketch termSketch;
+
+    struct InputStatistics decompressionTotals;
+    int numberOfDecompressedFiles;
+
+    bool reportToMaster;
+};
+
+/**
+ * Initialize the state of a worker
+ * @param worker The state to initialize
+ * @param rank The rank of the worker
+ * @param options The options of the run
+ * @param shuffle The shared shuffle of the node of the worker
+ * @param reportToMaster Whether the completed tasks are reported to the master
+ */
+static void initWorkerState(struct WorkerState * worker, int rank, struct RunOptions * options,
+                            struct SharedShuffle * shuffle, bool reportToMaster) {
+    worker->rank = rank;
+    worker->options = options;
+    worker->shuffle = shuffle;
+    worker->reportToMaster = reportToMaster;
+
+    // Every allocation of a task comes from this arena, which is reset once the task is reported
+    initArena(&worker->taskArena, DEFAULT_ARENA_BLOCK_SIZE);
+    worker->numberOfArenaAllocations = 0;
+    worker->peakArenaBytes = 0;
+
+    // The document lengths are loaded on the first ranked reverse index task, once the map stage is over
+    worker->documentLengthsLoaded = false;
+
+    // The lexicon segment of the worker is opened on its first reverse index task
+    worker->lexiconSegment.postings = worker->lexiconSegment.terms = NULL;
+
+    // The decompression of the map phase is reported once, when the worker stops
+    memset(&worker->decompressionTotals, 0, sizeof(struct InputStatistics));
+    worker->numberOfDecompressedFiles = 0;
+
+    // The distinct words of every direct-indexed file are counted, to estimate the postings of the final phase
+    if (options->balanceReduce) {
+        initFrequencySketch(&worker->termSketch, FREQUENCY_SKETCH_DEPTH, FREQUENCY_SKETCH_WIDTH);
+    }
+}
+
+/**
+ * Free the state of a worker
+ * @param worker The state to free
+ */
+static void freeWorkerState(struct WorkerState * worker) {
+    if (worker->numberOfArenaAllocations > 0) {
+        printf("Worker %d -> Tasks used %ld allocations, peak arena size %zu bytes\n",
+               worker->rank, worker->numberOfArenaAllocations, worker->peakArenaBytes);
+    }
+    if (worker->numberOfDecompressedFiles > 0) {
+        printf("%sWorker %d -> Decompressed %d input files, %ld compressed bytes into %ld bytes in %.3f s at %.1f MB/s%s\n", KBLU,
+               worker->rank, worker->numberOfDecompressedFiles, (long)worker->decompressionTotals.compressedBytes,
+               (long)worker->decompressionTotals.decompressedBytes, worker->decompressionTotals.decompressionTime / 1e6,
+               getDecompressionThroughput(&worker->decompressionTotals), KNRM);
+    }
+
+    if (worker->documentLengthsLoaded) {
+        freeWordCounter(&worker->documentLengths);
+    }
+    closeLexiconSegment(&worker->lexiconSegment);
+    if (worker->options->balanceReduce) {
+        freeFrequencySketch(&worker->termSketch);
+    }
+    freeArena(&worker->taskArena);
+}
+
+/**
+ * Write the final reverse index file of a word, and append the same postings to the lexicon segment of the worker
+ * @param worker The state of the worker
+ * @param word The word
+ * @param postings The postings of the word, with the flattened file names
+ * @param numberOfPostings The number of postings
+ */
+static void writeFinalWord(struct WorkerState * worker, char * word, struct WeightedPosting * postings, int numberOfPostings) {
+    size_t length;
+    char * formattedPostings = formatReverseIndexWord(postings, numberOfPostings, worker->options, &worker->documentLengths, &length);
+
+    if (!formattedPostings || !writeReverseIndexWord(word, formattedPostings, length, &worker->taskArena)) {
+        printf("%sWorker %d -> Could not write reverse-index file %s%s\n", KRED, worker->rank, word, KNRM);
+    } else if (worker->lexiconSegment.terms && !appendToLexiconSegment(&worker->lexiconSegment, word, formattedPostings, length)) {
+        printf("%sWorker %d -> Could not add word %s to the lexicon%s\n", KRED, worker->rank, word, KNRM);
+    }
+
+    free(formattedPostings);
+}
+
+/**
+ * Report the completion of a task to the master, together with the bytes the task read and wrote and the use of its arena
+ * Nothing is sent when the worker schedules its own tasks
+ * @param worker The state of the worker
+ * @param taskName The name of the completed task, as it was received, or NULL for tasks reported without a name
+ * @param tag The tag of the completed task
+ * @param taskStart The I/O counters of the worker when the task was received, the counters and the use of the arena
+ *                  are only sent when the options export them
+ */
+static void reportTask(struct WorkerState * worker, char * taskName, int tag, struct IoCounters * taskStart) {
+    if (!worker->reportToMaster) {
+        return;
+    }
+
+    char report[FILENAME_MAX];
+    int reportLength = formatTaskReport(report, FILENAME_MAX, taskName, worker->options->countTaskIo ? taskStart : NULL,
+                                        &worker->taskArena);
+
+    // Blocking send, since the task name buffer is reused for the next task
+    MPI_Send(report, reportLength, MPI_CHAR, ROOT, tag, MPI_COMM_WORLD);
+}
+
+/**
+ * Report the completion of a map task to the master, marked when the words of the file are in the shared segment
+ * of the worker, so that the master only sends its direct index task to the same node in that case
+ * @param worker The state of the worker
+ * @param fileName The name of the mapped file, as it was received
+ * @param taskStart The I/O counters of the worker when the task was received, only sent when the options export them
+ * @param sharedOutput Whether the record of the file was committed to the shared segment
+ */
+static void reportMapTask(struct WorkerState * worker, char * fileName, struct IoCounters * taskStart, bool sharedOutput) {
+    if (!worker->reportToMaster) {
+        return;
+    }
+
+    char report[FILENAME_MAX];
+    int reportLength = formatTaskReport(report, FILENAME_MAX, fileName, worker->options->countTaskIo ? taskStart : NULL,
+                                        &worker->taskArena);
+    if (sharedOutput) {
+        reportLength = appendSharedOutputMarker(report, reportLength, FILENAME_MAX);
+    }
+
+    MPI_Send(report, reportLength, MPI_CHAR, ROOT, TASK_PROCESS_WORDS, MPI_COMM_WORLD);
+}
+
+/**
+ * Execute a task on a worker and reset the arena of the task
+ * @param worker The state of the worker
+ * @param tag The tag of the task
+ * @param fileName The message of the task, a file name, a word, a batch of words or a job key
+ * @param taskLength The length of the message, which can hold more than the name
+ */
+static void executeTask(struct WorkerState * worker, int tag, char * fileName, int taskLength) {
+    // The bytes the task reads and writes are reported to the master with its completion, when they are exported
+    struct IoCounters taskIo = { 0, 0 };
+    if (worker->reportToMaster && worker->options->countTaskIo) {
+        readIoCounters(&taskIo);
+    }
+
+    // The tasks that write final reverse index files need the document lengths and the lexicon segment
+    if (tag == TASK_REVERSE_INDEX_WORD || tag == TASK_REVERSE_INDEX_MERGE) {
+        if (worker->options->rankedIndex && !worker->documentLengthsLoaded) {
+            initWordCounter(&worker->documentLengths, 1024);
+            loadDocumentLengths(DOCUMENT_LENGTHS_LOCATION, &worker->documentLengths);
+            worker->documentLengthsLoaded = true;
+        }
+
+        if (worker->options->buildLexicon && !worker->lexiconSegment.terms) {
+            openLexiconSegment(LEXICON_SEGMENTS_LOCATION, worker->rank, &worker->lexiconSegment);
+        }
+    }
+
+    switch(tag) {
+        case TASK_PROCESS_WORDS: {
+            char * fullPath = buildFilePath(FILES_DIRECTORY, fileName, &worker->taskArena);
+            char * storedName = flattenFilePath(fileName, &worker->taskArena);
+
+            // Compressed input files are detected by their magic bytes and decompressed while they are read
+            struct InputStatistics inputStatistics;
+            FILE * file = openInputFile(fullPath, &inputStatistics);
+            if (!file) {
+                printf("%sWorker %d -> Could not open file at \"%s\"!%s\n", KRED, worker->rank, fullPath, KNRM);
+
+                // The file is reported anyway, so that the master does not wait for it forever
+                reportTask(worker, fileName, TASK_PROCESS_WORDS, &taskIo);
+                break;
+            }
+
+            char * tempDirName = buildFilePath(TEMP_DIRNAME, storedName, &worker->taskArena);
+            mkdir(tempDirName, 0777);
+
+            // All the registered jobs are fed from this same tokenization pass
+            void * jobStates[MAX_MAP_REDUCE_JOBS];
+            for (int j = 0; j < getNumberOfMapReduceJobs(); j++) {
+                jobStates[j] = getMapReduceJob(j)->beginFile(storedName);
+            }
+
+            printf("%sWorker %d -> Opened file \"%s\"%s\n", KBLU, worker->rank, fullPath, KNRM);
+            char * word;
+            int numberOfWords = 0;
+
+            // The words of plain input files go to the shared segment of the worker when it has room for them,
+            // the size of the file bounds the length of its words
+            bool sharedOutput = inputStatistics.compression == NoCompression &&
+                                beginMapOutput(worker->shuffle, storedName, (size_t)inputStatistics.decompressedBytes + 1);
+
+            // Everything allocated for a word is released before the next one is read,
+            // so the arena does not grow with the size of the file
+            struct ArenaMark wordMark = markArena(&worker->taskArena);
+            while ((word = readWord(file, &worker->taskArena)) != NULL) {
+                if (sharedOutput && !appendMapOutput(worker->shuffle, word)) {
+                    // The segment is full, the words written so far are moved to the temporary directory
+                    uint32_t numberOfSharedWords;
+                    char * sharedWord = abandonMapOutput(worker->shuffle, &numberOfSharedWords);
+
+                    struct ArenaMark spillMark = markArena(&worker->taskArena);
+                    for (uint32_t i = 0; i < numberOfSharedWords; i++) {
+                        writeMapOutputFile(tempDirName, sharedWord, (int)i, worker->options->positionalIndex, &worker->taskArena);
+                        sharedWord += strlen(sharedWord) + 1;
+                        releaseArena(&worker->taskArena, spillMark);
+                    }
+
+                    sharedOutput = false;
+                }
+
+                if (!sharedOutput) {
+                    writeMapOutputFile(tempDirName, word, numberOfWords, worker->options->positionalIndex, &worker->taskArena);
+                }
+
+                numberOfWords++;
+
+                for (int j = 0; j < getNumberOfMapReduceJobs(); j++) {
+                    getMapReduceJob(j)->mapWord(jobStates[j], word);
+                }
+
+                releaseArena(&worker->taskArena, wordMark);
+            }
+
+            if (sharedOutput) {
+                commitMapOutput(worker->shuffle);
+            }
+
+            // A read error, e.g. a truncated compressed file, ends the file early, the words read so far are kept
+            if (ferror(file)) {
+                printf("%sWorker %d -> Could not read all of file \"%s\", only its first %d words are indexed!%s\n", KRED,
+                       worker->rank, fileName, numberOfWords, KNRM);
+            }
+
+            printf("%sWorker %d -> Found %d words in file \"%s\"%s\n", KBLU, worker->rank, numberOfWords, fileName, KNRM);
+
+            if (worker->options->rankedIndex) {
+                FILE * documentLengthFile = createFile(buildFilePath(DOCUMENT_LENGTHS_LOCATION, storedName, &worker->taskArena));
+                if (documentLengthFile) {
+                    fprintf(documentLengthFile, "%d\n", numberOfWords);
+                    fclose(documentLengthFile);
+                }
+            }
+
+            // Every job emits the pairs of the file on its own channel
+            for (int j = 0; j < getNumberOfMapReduceJobs(); j++) {
+                struct JobChannel channel;
+                channel.directory = buildFilePath(JOBS_LOCATION, getMapReduceJob(j)->name, &worker->taskArena);
+                channel.fileName = storedName;
+
+                getMapReduceJob(j)->endFile(jobStates[j], emitToJobChannel, &channel);
+            }
+
+            fclose(file);
+
+            if (inputStatistics.compression != NoCompression) {
+                printf("%sWorker %d -> Decompressed %ld %s bytes of file \"%s\" into %ld bytes at %.1f MB/s%s\n", KBLU,
+                       worker->rank, (long)inputStatistics.compressedBytes, getCompressionName(inputStatistics.compression),
+                       fileName, (long)inputStatistics.decompressedBytes, getDecompressionThroughput(&inputStatistics), KNRM);
+
+                addInputStatistics(&worker->decompressionTotals, &inputStatistics);
+                worker->numberOfDecompressedFiles++;
+            }
+
+            reportMapTask(worker, fileName, &taskIo, sharedOutput);
+            break;
+        }
+        case TASK_INDEX_FILE: {
+            char * storedName = flattenFilePath(fileName, &worker->taskArena);
+
+            // The master appends the rank that mapped the file when the map output is in shared memory
+            int producerRank = -1;
+            if ((size_t)taskLength > strlen(fileName) + 1) {
+                producerRank = atoi(fileName + strlen(fileName) + 1);
+            }
+
+            // The occurrences of the words, from the shared segment of the producer or from the temporary directory
+            struct MapOutputEntry * entries;
+            int numberOfEntries;
+            struct SharedRecordHeader * record = findMapOutput(worker->shuffle, storedName, producerRank);
+
+            if (record) {
+                numberOfEntries = (int)record->numberOfWords;
+                entries = (struct MapOutputEntry *)arenaAllocate(&worker->taskArena, (numberOfEntries + 1) * sizeof(struct MapOutputEntry));
+
+                char * sharedWord = getMapOutputWords(record);
+                for (int i = 0; i < numberOfEntries; i++) {
+                    entries[i].word = sharedWord;
+                    entries[i].position = (uint32_t)i;
+                    sharedWord += strlen(sharedWord) + 1;
+                }
+            } else {
+                struct DirectoryFiles df = getFileNamesForDirectory(buildFilePath(TEMP_DIRNAME, storedName, &worker->taskArena), &worker->taskArena);
+
+                numberOfEntries = df.numberOfFiles;
+                entries = (struct MapOutputEntry *)arenaAllocate(&worker->taskArena, (numberOfEntries + 1) * sizeof(struct MapOutputEntry));
+
+                for (int i = 0; i < numberOfEntries; i++) {
+                    char * savePointer;
+                    entries[i].word = strtok_r(df.filenames[i], "_", &savePointer);
+
+                    // Skip the timestamp to get to the position
+                    strtok_r(NULL, "_", &savePointer);
+                    char * position = strtok_r(NULL, "_", &savePointer);
+                    entries[i].position = position ? (uint32_t)strtoul(position, NULL, 10) : 0;
+                }
+            }
+
+            if (numberOfEntries == 0) {
+                printf("%sWorker %d -> No words found for file %s%s\n", KRED, worker->rank, fileName, KNRM);
+                if (record) { releaseMapOutput(worker->shuffle, record); }
+
+                reportTask(worker, fileName, TASK_INDEX_FILE, &taskIo);
+                break;
+            }
+
+            // The shared record is in reading order, the directory listing is already sorted
+            if (record) {
+                qsort(entries, numberOfEntries, sizeof(struct MapOutputEntry), compareMapOutputEntries);
+            }
+
+            char * directIndexFilePath = buildFilePath(DIRECT_INDEX_LOCATION, storedName, &worker->taskArena);
+            fclose(createFile(directIndexFilePath));
+
+            // The positions of every word are written on a line of their own, in the same order as the direct index
+            FILE * positionsFile = NULL;
+            uint32_t * positions = NULL;
+            if (worker->options->positionalIndex) {
+                positionsFile = createFile(buildFilePath(DIRECT_INDEX_POSITIONS_LOCATION, storedName, &worker->taskArena));
+                positions = (uint32_t *)arenaAllocate(&worker->taskArena, numberOfEntries * sizeof(uint32_t));
+            }
+
+            FILE * file = fopen(directIndexFilePath, "a");
+            if (!file) {
+                printf("%sWorker %d -> Could not write direct-index file %s%s\n", KRED, worker->rank, directIndexFilePath, KNRM);
+                if (positionsFile) { fclose(positionsFile); }
+                if (record) { releaseMapOutput(worker->shuffle, record); }
+
+                reportTask(worker, fileName, TASK_INDEX_FILE, &taskIo);
+                break;
+            }
+
+            // The entries are sorted, so all the occurrences of a word are consecutive
+            // The extra iteration past the last entry writes the last word
+            char * word;
+            char * lastWord = NULL;
+            int wordCount = 0;
+
+            for(int i = 0; i <= numberOfEntries; i++) {
+                word = i < numberOfEntries ? entries[i].word : NULL;
+
+                if (lastWord && (!word || strcmp(lastWord, word) != 0)) {
+                    fprintf(file, "%s %d\n", lastWord, wordCount);
+
+                    if (worker->options->balanceReduce) {
+                        addToFrequencySketch(&worker->termSketch, lastWord, 1);
+                    }
+
+                    if (positionsFile) {
+                        qsort(positions, wordCount, sizeof(uint32_t), comparePositions);
+
+                        fprintf(positionsFile, "%s", lastWord);
+                        for (int p = 0; p < wordCount; p++) {
+                            fprintf(positionsFile, " %u", positions[p]);
+                        }
+                        fprintf(positionsFile, "\n");
+                    }
+
+                    wordCount = 0;
+                }
+
+                if (word) {
+                    if (positionsFile) {
+                        positions[wordCount] = entries[i].position;
+                    }
+
+                    lastWord = word;
+                    wordCount++;
+                }
+            }
+
+            if (record) {
+                releaseMapOutput(worker->shuffle, record);
+            }
+
+            printf("%sWorker %d -> Indexed file %s%s\n", KGRN, worker->rank, fileName, KNRM);
+
+            fclose(file);
+            if (positionsFile) { fclose(positionsFile); }
+
+            reportTask(worker, fileName, TASK_INDEX_FILE, &taskIo);
+            break;
+        }
+
+        case TASK_REVERSE_INDEX_FILE: {
+            printf("%sWorker %d -> Received file %s for reverse-indexing%s\n", KYEL, worker->rank, fileName, KNRM);
+
+            char * storedName = flattenFilePath(fileName, &worker->taskArena);
+            char * filePath = buildFilePath(DIRECT_INDEX_LOCATION, storedName, &worker->taskArena);
+            FILE * directIndexFile = fopen(filePath, "r");
+            if (!directIndexFile) {
+                printf("%sWorker %d -> Could not read direct-index file %s%s\n", KRED, worker->rank, filePath, KNRM);
+
+                reportTask(worker, fileName, TASK_REVERSE_INDEX_FILE, &taskIo);
+                break;
+            }
+
+            // In positional mode the posting file of every word holds its encoded positions in the file
+            FILE * positionsFile = NULL;
+            if (worker->options->positionalIndex) {
+                filePath = buildFilePath(DIRECT_INDEX_POSITIONS_LOCATION, storedName, &worker->taskArena);
+                positionsFile = fopen(filePath, "r");
+                if (!positionsFile) {
+                    printf("%sWorker %d -> Could not read positions file %s%s\n", KRED, worker->rank, filePath, KNRM);
+                }
+            }
+
+            char * word;
+            char * numberOfApparitions;
+            struct ArenaMark wordMark = markArena(&worker->taskArena);
+            while ((word = readWord(directIndexFile, &worker->taskArena)) != NULL &&
+                (numberOfApparitions = readWord(directIndexFile, &worker->taskArena)) != NULL) {
+
+                char * wordPath = buildFilePath(REVERSE_INDEX_TEMP_LOCATION, word, &worker->taskArena);
+                mkdir(wordPath, 0777);
+
+                char fileNameToWrite[FILENAME_MAX];
+                sprintf(fileNameToWrite, "%s_%s_%ld", storedName, numberOfApparitions, getCurrentTimestamp());
+
+                FILE * wordFile = fopen(buildFilePath(wordPath, fileNameToWrite, &worker->taskArena), "a");
+
+                if (positionsFile && wordFile) {
+                    // The positions line starts with the word itself, followed by one position per apparition
+                    readWord(positionsFile, &worker->taskArena);
+
+                    int numberOfPositions = atoi(numberOfApparitions);
+                    uint32_t * positions = (uint32_t *)arenaAllocate(&worker->taskArena, numberOfPositions * sizeof(uint32_t));
+                    unsigned char * encoded = (unsigned char *)arenaAllocate(&worker->taskArena, numberOfPositions * MAX_VARINT_BYTES);
+
+                    for (int p = 0; p < numberOfPositions; p++) {
+                        char * position = readWord(positionsFile, &worker->taskArena);
+                        positions[p] = position ? (uint32_t)strtoul(position, NULL, 10) : 0;
+                    }
+
+                    fwrite(encoded, 1, encodePositions(positions, numberOfPositions, encoded), wordFile);
+                }
+
+                if (wordFile) { fclose(wordFile); }
+
+                releaseArena(&worker->taskArena, wordMark);
+            }
+
+            fclose(directIndexFile);
+            if (positionsFile) { fclose(positionsFile); }
+
+            reportTask(worker, fileName, TASK_REVERSE_INDEX_FILE, &taskIo);
+            break;
+        }
+
+        case TASK_REVERSE_INDEX_WORD: {
+            // The words of a batch are separated by new lines, a task with a single word is a batch of one
+            char * savePointer;
+            for (char * word = strtok_r(fileName, "\n", &savePointer); word; word = strtok_r(NULL, "\n", &savePointer)) {
+                struct ArenaMark wordMark = markArena(&worker->taskArena);
+
+                FILE * positionsFile = NULL;
+                if (worker->options->positionalIndex) {
+                    positionsFile = createFile(buildFilePath(REVERSE_INDEX_POSITIONS_LOCATION, word, &worker->taskArena));
+                }
+
+                struct WeightedPosting * postings;
+                int numberOfPostings = collectPostings(word, 0, 1, positionsFile, &postings, &worker->taskArena);
+                if (positionsFile) { fclose(positionsFile); }
+
+                writeFinalWord(worker, word, postings, numberOfPostings);
+
+                releaseArena(&worker->taskArena, wordMark);
+            }
+
+            // The batch itself is not echoed back, it can be longer than the messages the master receives
+            reportTask(worker, NULL, TASK_REVERSE_INDEX_WORD, &taskIo);
+            break;
+        }
+
+        case TASK_REVERSE_INDEX_PART: {
+            // A part of a split word writes its postings as {fileName} {count} lines, which the merge task formats
+            char word[FILENAME_MAX];
+            int part, numberOfParts;
+            if (!parseReducePart(fileName, word, &part, &numberOfParts)) {
+                printf("%sWorker %d -> Malformed reverse index part %s%s\n", KRED, worker->rank, fileName, KNRM);
+
+                reportTask(worker, fileName, TASK_REVERSE_INDEX_PART, &taskIo);
+                break;
+            }
+
+            // The master only splits the words whose part names fit in a file name
+            char partName[NAME_MAX + 1];
+            if (!formatReducePartName(partName, word, part, worker->options->positionalIndex)) {
+                printf("%sWorker %d -> Word %s is too long to be split%s\n", KRED, worker->rank, word, KNRM);
+
+                reportTask(worker, fileName, TASK_REVERSE_INDEX_PART, &taskIo);
+                break;
+            }
+
+            formatReducePartName(partName, word, part, false);
+            FILE * partFile = createFile(buildFilePath(REVERSE_INDEX_PARTS_LOCATION, partName, &worker->taskArena));
+
+            FILE * positionsFile = NULL;
+            if (worker->options->positionalIndex) {
+                formatReducePartName(partName, word, part, true);
+                positionsFile = createFile(buildFilePath(REVERSE_INDEX_PARTS_LOCATION, partName, &worker->taskArena));
+            }
+
+            struct WeightedPosting * postings;
+            int numberOfPostings = collectPostings(word, part, numberOfParts, positionsFile, &postings, &worker->taskArena);
+            if (positionsFile) { fclose(positionsFile); }
+
+            if (partFile) {
+                for (int i = 0; i < numberOfPostings; i++) {
+                    fprintf(partFile, "%s %ld\n", postings[i].fileName, postings[i].count);
+                }
+                fclose(partFile);
+            } else {
+                printf("%sWorker %d -> Could not write part %d of word %s%s\n", KRED, worker->rank, part, word, KNRM);
+            }
+
+            printf("%sWorker %d -> Reverse-indexed part %d of %d of word %s%s\n", KMAG, worker->rank, part + 1, numberOfParts, word, KNRM);
+
+            reportTask(worker, fileName, TASK_REVERSE_INDEX_PART, &taskIo);
+            break;
+        }
+
+        case TASK_REVERSE_INDEX_MERGE: {
+            char word[FILENAME_MAX];
+            int part, numberOfParts;
+            if (!parseReducePart(fileName, word, &part, &numberOfParts)) {
+                printf("%sWorker %d -> Malformed reverse index merge %s%s\n", KRED, worker->rank, fileName, KNRM);
+
+                reportTask(worker, fileName, TASK_REVERSE_INDEX_MERGE, &taskIo);
+                break;
+            }
+
+            // The positions records are self delimiting, so the parts are appended as they are
+            FILE * positionsFile = NULL;
+            if (worker->options->positionalIndex) {
+                positionsFile = createFile(buildFilePath(REVERSE_INDEX_POSITIONS_LOCATION, word, &worker->taskArena));
+            }
+
+            struct WeightedPosting * postings = NULL;
+            int numberOfPostings = 0;
+            int postingsCapacity = 0;
+
+            for (int p = 0; p < numberOfParts; p++) {
+                char partName[NAME_MAX + 1];
+                FILE * partFile = NULL;
+                if (formatReducePartName(partName, word, p, false)) {
+                    partFile = fopen(buildFilePath(REVERSE_INDEX_PARTS_LOCATION, partName, &worker->taskArena), "r");
+                }
+                if (!partFile) {
+                    printf("%sWorker %d -> Could not read part %d of word %s%s\n", KRED, worker->rank, p, word, KNRM);
+                    continue;
+                }
+
+                char postingName[FILENAME_MAX];
+                long count;
+                while (fscanf(partFile, "%4095s %ld", postingName, &count) == 2) {
+                    if (numberOfPostings == postingsCapacity) {
+                        struct WeightedPosting * previousPostings = postings;
+                        postingsCapacity = postingsCapacity ? postingsCapacity * 2 : 256;
+                        postings = (struct WeightedPosting *)arenaAllocate(&worker->taskArena, postingsCapacity * sizeof(struct WeightedPosting));
+                        if (previousPostings) {
+                            memcpy(postings, previousPostings, numberOfPostings * sizeof(struct WeightedPosting));
+                        }
+                    }
+
+                    postings[numberOfPostings].fileName = arenaDuplicate(&worker->taskArena, postingName);
+                    postings[numberOfPostings].count = count;
+                    postings[numberOfPostings].weight = 0.0;
+                    numberOfPostings++;
+                }
+                fclose(partFile);
+
+                if (positionsFile) {
+                    FILE * partPositionsFile = NULL;
+                    if (formatReducePartName(partName, word, p, true)) {
+                        partPositionsFile = fopen(buildFilePath(REVERSE_INDEX_PARTS_LOCATION, partName, &worker->taskArena), "rb");
+                    }
+                    if (partPositionsFile) {
+                        char buffer[8192];
+                        size_t bytesRead;
+                        while ((bytesRead = fread(buffer, 1, sizeof(buffer), partPositionsFile)) > 0) {
+                            fwrite(buffer, 1, bytesRead, positionsFile);
+                        }
+                        fclose(partPositionsFile);
+                    }
+                }
+            }
+            if (positionsFile) { fclose(positionsFile); }
+
+            // The parts were split by the hash of the posting names, the postings are put back in the order of a single task
+            qsort(postings, numberOfPostings, sizeof(struct WeightedPosting), comparePostingNames);
+
+            writeFinalWord(worker, word, postings, numberOfPostings);
+
+            printf("%sWorker %d -> Merged the %d parts of word %s%s\n", KMAG, worker->rank, numberOfParts, word, KNRM);
+
+            reportTask(worker, fileName, TASK_REVERSE_INDEX_MERGE, &taskIo);
+            break;
+        }
+
+        case TASK_FLUSH_SKETCH: {
+            char rankName[42];
+            sprintf(rankName, "%d", worker->rank);
+
+            if (!writeFrequencySketch(&worker->termSketch, buildFilePath(SKETCHES_LOCATION, rankName, &worker->taskArena))) {
+                printf("%sWorker %d -> Could not write the frequency sketch%s\n", KRED, worker->rank, KNRM);
+            }
+
+            reportTask(worker, NULL, TASK_FLUSH_SKETCH, &taskIo);
+            break;
+        }
+
+        case TASK_JOB_REDUCE: {
+            // The task is sent as {job}/{key}
+            char * key = strchr(fileName, '/');
+            struct MapReduceJob * job = NULL;
+            if (key) {
+                *key = '\0';
+                job = findMapReduceJob(fileName);
+                key++;
+            }
+
+            if (!job) {
+                printf("%sWorker %d -> Unknown job for task %s%s\n", KRED, worker->rank, fileName, KNRM);
+            } else {
+                char * channelDirectory = buildFilePath(JOBS_LOCATION, job->name, &worker->taskArena);
+                char * outputDirectory = buildFilePath(JOBS_OUTPUT_LOCATION, job->name, &worker->taskArena);
+
+                if (!reduceJobKey(job, channelDirectory, key, outputDirectory)) {
+                    printf("%sWorker %d -> Could not reduce key %s of job %s%s\n", KRED, worker->rank, key, job->name, KNRM);
+                }
+            }
+
+            reportTask(worker, NULL, TASK_JOB_REDUCE, &taskIo);
+            break;
+        }
+    }
+
+    // Every task reports the use of its arena with its completion, the totals are printed once, when the worker stops
+    worker->numberOfArenaAllocations += worker->taskArena.numberOfAllocations;
+    if (worker->taskArena.peakBytes > worker->peakArenaBytes) {
+        worker->peakArenaBytes = worker->taskArena.peakBytes;
+    }
+    resetArena(&worker->taskArena);
+}
+
+/**
+ * Create the directories of all the stages of processing, and the ones of the enabled options
+ * @param options The options of the run
+ * @return True or false, whether all the directories could be created
+ */
+static bool createOutputDirectories(struct RunOptions * options) {
+    // Create the directories for all four stages of processing
+    // Get Words, Direct Index, "Pre" Reverse Index and Final Reverse Index
+    int tempDirectoryCreated = mkdir(TEMP_DIRNAME, 0777);
+    int directIndexDirectoryCreated = mkdir(DIRECT_INDEX_LOCATION, 0777);
+    int reverseIndexTempDirectoryCreated = mkdir(REVERSE_INDEX_TEMP_LOCATION, 0777);
+    int reverseIndexDirectoryCreated = mkdir(REVERSE_INDEX_LOCATION, 0777);
+
+    // The positional index keeps the positions next to the direct and final reverse index
+    int positionsDirectoriesCreated = 0;
+    if (options->positionalIndex) {
+        positionsDirectoriesCreated = mkdir(DIRECT_INDEX_POSITIONS_LOCATION, 0777) |
+                                      mkdir(REVERSE_INDEX_POSITIONS_LOCATION, 0777);
+    }
+
+    // The ranked reverse index needs the number of words of every input file
+    int documentLengthsDirectoryCreated = 0;
+    if (options->rankedIndex) {
+        documentLengthsDirectoryCreated = mkdir(DOCUMENT_LENGTHS_LOCATION, 0777);
+    }
+
+    // The workers write the postings of the lexicon in segments, one per worker
+    int lexiconDirectoryCreated = 0;
+    if (options->buildLexicon) {
+        lexiconDirectoryCreated = mkdir(LEXICON_SEGMENTS_LOCATION, 0777);
+    }
+
+    // The balanced final stage needs the frequency sketches of the workers and a place for the parts of split words
+    int balanceDirectoriesCreated = 0;
+    if (options->balanceReduce) {
+        balanceDirectoriesCreated = mkdir(SKETCHES_LOCATION, 0777) | mkdir(REVERSE_INDEX_PARTS_LOCATION, 0777);
+    }
+
+    // Every registered job gets its own channel directory and output directory
+    int jobDirectoriesCreated = 0;
+    if (getNumberOfMapReduceJobs() > 0) {
+        jobDirectoriesCreated |= mkdir(JOBS_LOCATION, 0777) | mkdir(JOBS_OUTPUT_LOCATION, 0777);
+
+        for (int i = 0; i < getNumberOfMapReduceJobs(); i++) {
+            char * channelDirectory = buildFilePath(JOBS_LOCATION, getMapReduceJob(i)->name, NULL);
+            char * outputDirectory = buildFilePath(JOBS_OUTPUT_LOCATION, getMapReduceJob(i)->name, NULL);
+
+            jobDirectoriesCreated |= mkdir(channelDirectory, 0777) | mkdir(outputDirectory, 0777);
+
+            free(channelDirectory);
+            free(outputDirectory);
+        }
+    }
+
+    return jobDirectoriesCreated != -1 &&
+           positionsDirectoriesCreated != -1 &&
+           documentLengthsDirectoryCreated != -1 &&
+           lexiconDirectoryCreated != -1 &&
+           balanceDirectoriesCreated != -1 &&
+           tempDirectoryCreated != -1 &&
+           directIndexDirectoryCreated != -1 &&
+           reverseIndexTempDirectoryCreated != -1 &&
+           reverseIndexDirectoryCreated != -1;
+}
+
+/**
+ * Open the channel of the next job whose keys can be read, the channels that can not be opened are skipped
+ * @param currentJob The index of the current job, -1 before the first one, updated to the job of the opened channel
+ * @return The stream of the channel, or NULL once there are no more jobs
+ */
+static struct DirectoryStream * openNextJobChannel(int * currentJob) {
+    while (++(*currentJob) < getNumberOfMapReduceJobs()) {
+        char * channelDirectory = buildFilePath(JOBS_LOCATION, getMapReduceJob(*currentJob)->name, NULL);
+        struct DirectoryStream * stream = openDirectoryStream(channelDirectory, false);
+        free(channelDirectory);
+
+        if (stream) {
+            return stream;
+        }
+        printf("%sRoot -> Skipping the keys of the job %s%s\n", KRED, getMapReduceJob(*currentJob)->name, KNRM);
+    }
+
+    return NULL;
+}
+
+/**
+ * Read all the names of a directory, sorted, so that every rank numbers them the same way
+ * @param directoryName The directory to read
+ * @param recursive Whether the subdirectories are read too
+ * @param names Where the names are stored, allocated with malloc
+ * @return The number of names, -1 when the directory could not be read
+ */
+static int readSortedDirectory(char * directoryName, bool recursive, char *** names) {
+    int numberOfNames = 0;
+    int capacity = DIRECTORY_BATCH_SIZE;
+    *names = (char **)malloc(capacity * sizeof(char *));
+
+    struct DirectoryStream * stream = openDirectoryStream(directoryName, recursive);
+    if (!stream) {
+        return -1;
+    }
+
+    int numberOfRead;
+    do {
+        if (numberOfNames + DIRECTORY_BATCH_SIZE > capacity) {
+            capacity *= 2;
+            *names = (char **)realloc(*names, capacity * sizeof(char *));
+        }
+
+        numberOfRead = readDirectoryBatch(stream, *names + numberOfNames, DIRECTORY_BATCH_SIZE, NULL);
+        numberOfNames += numberOfRead;
+    } while (numberOfRead > 0);
+
+    closeDirectoryStream(stream);
+    qsort(*names, numberOfNames, sizeof(char *), compareNames);
+
+    return numberOfNames;
+}
+
+/**
+ * Read all the names of a directory on rank 0 and send them to the other ranks, collective over all the ranks
+ * A single listing keeps the tasks of every rank the same, even when the ranks see the shared directory differently
+ * The names are sent after each other, each followed by its terminating character
+ * @param rank The rank of the process
+ * @param directoryName The directory to read
+ * @param recursive Whether the subdirectories are read too
+ * @param names Where the names are stored, allocated with malloc
+ * @return The number of names, -1 on all the ranks when rank 0 could not read the directory
+ */
+static int broadcastSortedDirectory(int rank, char * directoryName, bool recursive, char *** names) {
+    // The number of names and the length of all of them
+    long listing[2] = { 0, 0 };
+    char * packedNames = NULL;
+
+    if (rank == ROOT) {
+        listing[0] = readSortedDirectory(directoryName, recursive, names);
+        for (int i = 0; i < listing[0]; i++) {
+            listing[1] += (long)strlen((*names)[i]) + 1;
+        }
+
+        packedNames = (char *)malloc(listing[1] + 1);
+        char * cursor = packedNames;
+        for (int i = 0; i < listing[0]; i++) {
+            size_t nameSize = strlen((*names)[i]) + 1;
+            memcpy(cursor, (*names)[i], nameSize);
+            cursor += nameSize;
+        }
+    }
+
+    MPI_Bcast(listing, 2, MPI_LONG, ROOT, MPI_COMM_WORLD);
+    if (rank != ROOT) {
+        packedNames = (char *)malloc(listing[1] + 1);
+    }
+    MPI_Bcast(packedNames, (int)listing[1], MPI_CHAR, ROOT, MPI_COMM_WORLD);
+
+    if (rank != ROOT) {
+        *names = (char **)malloc((listing[0] > 0 ? listing[0] : 1) * sizeof(char *));
+
+        char * cursor = packedNames;
+        for (int i = 0; i < listing[0]; i++) {
+            (*names)[i] = strdup(cursor);
+            cursor += strlen(cursor) + 1;
+        }
+    }
+
+    free(packedNames);
+    return (int)listing[0];
+}
+
+/**
+ * Run a phase on every rank, the tasks are taken from the own block of the rank first, then stolen from the other ranks
+ * @param worker The state of the worker of the rank
+ * @param phase The name of the phase, for the logs
+ * @param numberOfTasks The number of tasks of the phase
+ * @param runTask The function that runs a task given its index
+ * @param context The context of the tasks
+ */
+static void runStolenPhase(struct WorkerState * worker, char * phase, int numberOfTasks,
+                           void (*runTask)(struct WorkerState *, int, void *), void * context) {
+    struct WorkStealer stealer;
+    initWorkStealer(&stealer, numberOfTasks);
+
+    int numberOfOwnTasks = stealer.last;
+    int numberOfRunTasks = 0;
+    int task;
+    while ((task = getNextStolenTask(&stealer)) >= 0) {
+        runTask(worker, task, context);
+        numberOfRunTasks++;
+    }
+
+    printf("%sRank %d -> Ran %d %s tasks, %d of its own block of %d, stole %ld tasks with %ld requests%s\n", KMAG,
+           worker->rank, numberOfRunTasks, phase, numberOfRunTasks - (int)stealer.tasksStolen, numberOfOwnTasks,
+           stealer.tasksStolen, stealer.stealRequests, KNRM);
+
+    freeWorkStealer(&stealer);
+}
+
+/**
+ * Run the map, direct index and first reverse index stages of an input file, one after the other on the same rank
+ * @param worker The state of the worker of the rank
+ * @param task The index of the input file
+ * @param context The sorted names of the input files
+ */
+static void runFileTask(struct WorkerState * worker, int task, void * context) {
+    char * fileName = ((char **)context)[task];
+    char message[FILENAME_MAX + 16];
+
+    int messageLength = snprintf(message, FILENAME_MAX, "%s", fileName) + 1;
+    executeTask(worker, TASK_PROCESS_WORDS, message, messageLength);
+
+    // The words of the file are in the shared segment of this same rank
+    if (worker->shuffle->enabled) {
+        messageLength += snprintf(message + messageLength, 16, "%d", worker->rank) + 1;
+    }
+    executeTask(worker, TASK_INDEX_FILE, message, messageLength);
+
+    messageLength = snprintf(message, FILENAME_MAX, "%s", fileName) + 1;
+    executeTask(worker, TASK_REVERSE_INDEX_FILE, message, messageLength);
+}
+
+/**
+ * Run the final reverse index of a word, or the reduction of a job key given as {job}/{key}
+ * @param worker The state of the worker of the rank
+ * @param task The index of the word or job key, the job keys follow the words
+ * @param context The sorted words, followed by the job keys
+ */
+static void runReduceTask(struct WorkerState * worker, int task, void * context) {
+    char * name = ((char **)context)[task];
+    char message[FILENAME_MAX];
+
+    int messageLength = snprintf(message, FILENAME_MAX, "%s", name) + 1;
+    executeTask(worker, strchr(name, '/') ? TASK_JOB_REDUCE : TASK_REVERSE_INDEX_WORD, message, messageLength);
+}
+
+/**
+ * Run the whole algorithm without a master, with --distributed
+ * Every rank, including rank 0, works on a static block of the tasks of every phase and steals from the others
+ * once its block is done. The end of every phase is detected by the ranks themselves, see WorkStealing.c
+ * @param rank The rank of the process
+ * @param options The options of the run
+ * @param shuffle The shared shuffle of the node of the rank
+ */
+static void runDistributedScheduling(int rank, struct RunOptions * options, struct SharedShuffle * shuffle) {
+    int directoriesCreated = 0;
+    if (rank == ROOT) {
+        directoriesCreated = createOutputDirectories(options);
+        if (!directoriesCreated) {
+            printf("%s_temp, direct-index, reverse-index temporary, final, positions, document lengths, lexicon, balancing or job directories could not be created!%s\n", KRED, KNRM);
+        }
+        if (options->balanceReduce || options->metricsFile || options->metricsSocket) {
+            printf("%s--balance and the metrics are not used with --distributed, the ranks balance the tasks by stealing them%s\n", KYEL, KNRM);
+        }
+    }
+    MPI_Bcast(&directoriesCreated, 1, MPI_INT, ROOT, MPI_COMM_WORLD);
+    if (!directoriesCreated) {
+        return;
+    }
+
+    struct WorkerState worker;
+    initWorkerState(&worker, rank, options, shuffle, false);
+
+    // Rank 0 lists and sorts the input files for all the ranks, so that the blocks of tasks match
+    char ** fileNames;
+    int numberOfFiles = broadcastSortedDirectory(rank, FILES_DIRECTORY, options->recursiveInput, &fileNames);
+    if (numberOfFiles < 0) {
+        if (rank == ROOT) {
+            printf("%sRank %d -> Could not read the input files%s\n", KRED, rank, KNRM);
+        }
+        numberOfFiles = 0;
+    }
+    if (rank == ROOT) {
+        printf("Rank %d -> Discovered a number of %d input files\n", rank, numberOfFiles);
+    }
+
+    runStolenPhase(&worker, "file", numberOfFiles, runFileTask, fileNames);
+
+    for (int i = 0; i < numberOfFiles; i++) {
+        free(fileNames[i]);
+    }
+    free(fileNames);
+
+    // The final phase starts once the first one is over on all the ranks, the job keys follow the words
+    char ** reduceNames;
+    int numberOfWords = broadcastSortedDirectory(rank, REVERSE_INDEX_TEMP_LOCATION, false, &reduceNames);
+    if (numberOfWords < 0) {
+        if (rank == ROOT) {
+            printf("%sRank %d -> Could not read the words to reverse index%s\n", KRED, rank, KNRM);
+        }
+        numberOfWords = 0;
+    }
+    int numberOfReduceTasks = numberOfWords;
+
+    for (int j = 0; j < getNumberOfMapReduceJobs(); j++) {
+        char * channelDirectory = buildFilePath(JOBS_LOCATION, getMapReduceJob(j)->name, NULL);
+        char ** keys;
+        int numberOfKeys = broadcastSortedDirectory(rank, channelDirectory, false, &keys);
+        if (numberOfKeys < 0) {
+            if (rank == ROOT) {
+                printf("%sRank %d -> Skipping the keys of the job %s%s\n", KRED, rank, getMapReduceJob(j)->name, KNRM);
+            }
+            numberOfKeys = 0;
+        }
+
+        reduceNames = (char **)realloc(reduceNames, (numberOfReduceTasks + numberOfKeys + 1) * sizeof(char *));
+        for (int k = 0; k < numberOfKeys; k++) {
+            char taskName[FILENAME_MAX];
+            snprintf(taskName, FILENAME_MAX, "%s/%s", getMapReduceJob(j)->name, keys[k]);
+            reduceNames[numberOfReduceTasks++] = strdup(taskName);
+            free(keys[k]);
+        }
+
+        free(keys);
+        free(channelDirectory);
+    }
+
+    runStolenPhase(&worker, "reduce", numberOfReduceTasks, runReduceTask, reduceNames);
+
+    for (int i = 0; i < numberOfReduceTasks; i++) {
+        free(reduceNames[i]);
+    }
+    free(reduceNames);
+
+    // Every lexicon segment is closed before rank 0 reads them
+    freeWorkerState(&worker);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (rank == ROOT) {
+        printf("%sRank %d -> Finished reverse indexing a number of %d words%s\n", KMAG, rank, numberOfWords, KNRM);
+
+        if (options->buildLexicon) {
+            if (buildLexiconFromSegments(LEXICON_SEGMENTS_LOCATION, LEXICON_LOCATION)) {
+                printf("%sRank %d -> Built the lexicon of %d words%s\n", KMAG, rank, numberOfWords, KNRM);
+            } else {
+                printf("%sRank %d -> Could not build the lexicon%s\n", KRED, rank, KNRM);
+            }
+        }
+    }
+}
 
 int main(int argc, char ** argv) {
     // SEGMENTATION FAULT HANDLER
@@ -54,51 +1378,101 @@ int main(int argc, char ** argv) {
     int CURRENT_RANK;
     MPI_Comm_rank(MPI_COMM_WORLD, &CURRENT_RANK);
 
+    struct RunOptions options = parseRunOptions(argc, argv);
+
+    // Every process registers the same jobs, so that the job indexes match between the master and the workers
+    // Every process parses the same --jobs, so they all stop when one of the names is unknown
+    if (options.jobs && !registerBuiltinJobs(options.jobs)) {
+        if (CURRENT_RANK == ROOT) {
+            printf("%sThe jobs %s could not be registered, the known jobs are document-length, vocabulary-size and bigrams!%s\n", KRED, options.jobs, KNRM);
+        }
+        MPI_Finalize();
+        return 0;
+    }
+
+    // Every process takes part in setting up the shared segments of its node, the master does not get one
+    struct SharedShuffle shuffle;
+    initSharedShuffle(&shuffle, options.sharedShuffle, (size_t)options.sharedSegmentMegabytes * 1024 * 1024,
+                      CURRENT_RANK != ROOT || options.distributedScheduling);
+
+    // Without a master, every rank schedules its own tasks and steals from the others
+    if (options.distributedScheduling) {
+        runDistributedScheduling(CURRENT_RANK, &options, &shuffle);
+
+        freeSharedShuffle(&shuffle);
+        MPI_Finalize();
+        return 0;
+    }
+
     MPI_Status status;
 
     if (CURRENT_RANK == ROOT) {
-        struct DirectoryFiles df = getFileNamesForDirectory(FILES_DIRECTORY);
+        // The input files are discovered in batches while the workers are already mapping the first ones
+        struct DirectoryStream * inputStream = openDirectoryStream(FILES_DIRECTORY, options.recursiveInput);
         int fileIndex;
 
-        // Create the directories for all four stages of processing
-        // Get Words, Direct Index, "Pre" Reverse Index and Final Reverse Index
-        int tempDirectoryCreated = mkdir(TEMP_DIRNAME, 0777);
-        int directIndexDirectoryCreated = mkdir(DIRECT_INDEX_LOCATION, 0777);
-        int reverseIndexTempDirectoryCreated = mkdir(REVERSE_INDEX_TEMP_LOCATION, 0777);
-        int reverseIndexDirectoryCreated = mkdir(REVERSE_INDEX_LOCATION, 0777);
+        bool directoriesCreated = createOutputDirectories(&options);
 
         // If any directory creation failed, the algorithm will not continue further
-        if (tempDirectoryCreated == -1 ||
-            directIndexDirectoryCreated == -1 ||
-            reverseIndexTempDirectoryCreated == -1 ||
-            reverseIndexDirectoryCreated == -1) {
-            printf("%s_temp, direct-index, reverse-index temporary or final directory could not be created!%s\n", KRED, KNRM);
+        if (!inputStream || !directoriesCreated) {
+            printf("%sinput-files could not be opened or _temp, direct-index, reverse-index temporary, final, positions, document lengths, lexicon, balancing or job directories could not be created!%s\n", KRED, KNRM);
             for(int processRank = 1; processRank < NUMBER_OF_PROCESSES; processRank++) {
                 printf("%sSENDING KILL TO %d%s\n", KRED, processRank, KNRM);
 
                 MPI_Request kill_req;
                 MPI_Isend(NULL, 0, MPI_CHAR, processRank, TASK_KILL, MPI_COMM_WORLD, &kill_req);
             }
+            freeSharedShuffle(&shuffle);
             MPI_Finalize();
             return 0;
         }
 
-        // Create a list of the input files that contains the filename, the current operation
-        // and the last operation that was executed on that file
-        struct Operation * reduceOperations = (struct Operation *) malloc(df.numberOfFiles * sizeof(struct Operation));
-        int numberOfOperations = df.numberOfFiles;
+        // The live counters of the scheduler, exported when --metrics-file or --metrics-socket is given
+        struct Metrics metrics;
+        initMetrics(&metrics, NUMBER_OF_PROCESSES, options.metricsFile, options.metricsSocket, options.tracePath);
 
-        for (fileIndex = 0; fileIndex < numberOfOperations; fileIndex++) {
-            reduceOperations[fileIndex].filename = df.filenames[fileIndex]->d_name;
-            reduceOperations[fileIndex].currentOperation = reduceOperations[fileIndex].lastOperation = Available;
+        // A list of the input files that contains the filename, the current operation
+        // and the last operation that was executed on that file, it grows as the input files are discovered
+        struct Operation * reduceOperations = NULL;
+        int numberOfOperations = 0;
+        int operationsCapacity = 0;
+
+        // Workers that reported back and did not receive a new task yet
+        bool idleWorkers[NUMBER_OF_PROCESSES];
+        for (int i = 0; i < NUMBER_OF_PROCESSES; i++) {
+            idleWorkers[i] = false;
         }
 
         MPI_Request req;
         int flag;
         MPI_Status status;
 
-        // The MASTER process will keep listening for messages from workers while not all files are completely processed
-        while(doableOperations(reduceOperations, numberOfOperations)) {
+        // The MASTER process will keep listening for messages from workers while not all files are discovered
+        // and completely processed
+        while(inputStream || doableOperations(reduceOperations, numberOfOperations)) {
+            if (inputStream) {
+                char * names[DIRECTORY_BATCH_SIZE];
+                int numberOfNames = readDirectoryBatch(inputStream, names, DIRECTORY_BATCH_SIZE, NULL);
+
+                if (numberOfNames == 0) {
+                    closeDirectoryStream(inputStream);
+                    inputStream = NULL;
+                    printf("Root -> Discovered a number of %d input files\n", numberOfOperations);
+                }
+
+                if (numberOfOperations + numberOfNames > operationsCapacity) {
+                    operationsCapacity = (numberOfOperations + numberOfNames) * 2;
+                    reduceOperations = (struct Operation *) realloc(reduceOperations, operationsCapacity * sizeof(struct Operation));
+                }
+
+                for (int i = 0; i < numberOfNames; i++) {
+                    fileIndex = numberOfOperations++;
+                    reduceOperations[fileIndex].filename = names[i];
+                    reduceOperations[fileIndex].currentOperation = reduceOperations[fileIndex].lastOperation = Available;
+                    reduceOperations[fileIndex].mapRank = 0;
+                }
+            }
+
             char * processedFile = (char *)malloc(FILENAME_MAX);
             MPI_Irecv(processedFile, FILENAME_MAX, MPI_CHAR, MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &req);
 
@@ -107,6 +1481,10 @@ int main(int argc, char ** argv) {
                 int destination = status.MPI_SOURCE;
                 int receivedTag = status.MPI_TAG;
 
+                int messageLength;
+                MPI_Get_count(&status, MPI_CHAR, &messageLength);
+                recordTaskCompleted(&metrics, destination, receivedTag, processedFile, messageLength);
+
                 // Handle the finish of a worker operation
                 switch (receivedTag) {
                     case TASK_INDEX_FILE: {
@@ -124,6 +1502,10 @@ int main(int argc, char ** argv) {
                         changeOperationCurrentStatusByName(reduceOperations, numberOfOperations, processedFile, Available);
                         changeOperationLastStatusByName(reduceOperations, numberOfOperations, processedFile, GetWords);
 
+                        // Only the words left in the shared segment of the worker tie the file to its node
+                        int mapRank = hasSharedOutputMarker(processedFile, messageLength) ? destination : 0;
+                        changeOperationMapRankByName(reduceOperations, numberOfOperations, processedFile, mapRank);
+
                         break;
                     }
 
@@ -134,8 +1516,28 @@ int main(int argc, char ** argv) {
                     }
                 }
 
-                struct Operation * nextOperation = getNextOperation(reduceOperations, numberOfOperations);
-                if (!nextOperation) { printf("No next Operation found!\n"); continue; }
+                idleWorkers[destination] = true;
+            } else {
+                // Cancel and free the listener for the request if no message came trough
+                MPI_Cancel(&req);
+                MPI_Request_free(&req);
+            }
+
+            // Hand out the available operations to the idle workers, including the ones that found nothing to do
+            // before the rest of the input files were discovered
+            // With the shared shuffle, a file is only direct-indexed on the node that mapped it
+            int * nodeOfRank = shuffle.enabled ? shuffle.nodeOfRank : NULL;
+            for (int destination = 1; destination < NUMBER_OF_PROCESSES &&
+                                      getNextOperation(reduceOperations, numberOfOperations) != NULL; destination++) {
+                if (!idleWorkers[destination]) {
+                    continue;
+                }
+
+                struct Operation * nextOperation = getNextOperationForWorker(reduceOperations, numberOfOperations,
+                                                                             destination, nodeOfRank);
+                if (nextOperation == NULL) {
+                    continue;
+                }
 
                 changeOperationCurrentStatusByName(reduceOperations, numberOfOperations,
                                                    nextOperation->filename, InProgress);
@@ -143,74 +1545,183 @@ int main(int argc, char ** argv) {
 
                 printf("ROOT -> Sending file %s to %d on task %d\n", nextOperation->filename, destination, nextTask);
 
-                MPI_Request task_req;
-                MPI_Isend(nextOperation->filename,
-                         strlen(nextOperation->filename) + 1,
-                         MPI_CHAR,
-                         destination,
-                         nextTask,
-                         MPI_COMM_WORLD,
-                         &task_req);
-            } else {
-                // Cancel and free the listener for the request if no message came trough
-                MPI_Cancel(&req);
-                MPI_Request_free(&req);
+                // The direct index task also names the worker whose shared segment holds the words of the file, if any
+                char taskMessage[FILENAME_MAX + 16];
+                int taskLength = snprintf(taskMessage, FILENAME_MAX, "%s", nextOperation->filename) + 1;
+                if (shuffle.enabled && nextTask == TASK_INDEX_FILE && nextOperation->mapRank > 0) {
+                    taskLength += snprintf(taskMessage + taskLength, 16, "%d", nextOperation->mapRank) + 1;
+                }
+
+                // Blocking send, since the task message is built on the stack
+                MPI_Send(taskMessage, taskLength, MPI_CHAR, destination, nextTask, MPI_COMM_WORLD);
+
+                recordTaskDispatched(&metrics, destination, nextTask);
+                idleWorkers[destination] = false;
             }
 
+            pollMetrics(&metrics, 1, reduceOperations, numberOfOperations, 0);
+
             free(processedFile);
         }
 
-        free(reduceOperations);
         printf("Root -> GetWords, DirectIndexing and the first stage of ReverseIndexing are finished\n");
-        for (int i = 0; i < df.numberOfFiles; i++) {
-            free(df.filenames[i]);
+        updateMetrics(&metrics, 2, reduceOperations, numberOfOperations, 0);
+        for (int i = 0; i < numberOfOperations; i++) {
+            free(reduceOperations[i].filename);
+        }
+        free(reduceOperations);
+
+        /**
+         * With --balance, the workers write the frequency sketches they built while direct-indexing,
+         * which estimate the number of postings of every word of the final phase
+         */
+        struct FrequencySketch termSketch;
+        bool termSketchLoaded = false;
+        if (options.balanceReduce) {
+            for (int processRank = 1; processRank < NUMBER_OF_PROCESSES; processRank++) {
+                MPI_Send(NULL, 0, MPI_CHAR, processRank, TASK_FLUSH_SKETCH, MPI_COMM_WORLD);
+            }
+            for (int processRank = 1; processRank < NUMBER_OF_PROCESSES; processRank++) {
+                char flushReport[FILENAME_MAX];
+                MPI_Recv(flushReport, FILENAME_MAX, MPI_CHAR, MPI_ANY_SOURCE, TASK_FLUSH_SKETCH, MPI_COMM_WORLD, &status);
+            }
+
+            termSketchLoaded = loadFrequencySketches(SKETCHES_LOCATION, &termSketch);
+            if (!termSketchLoaded) {
+                freeFrequencySketch(&termSketch);
+                printf("%sROOT -> Could not read the frequency sketches, words are reverse-indexed one by one%s\n", KRED, KNRM);
+            }
+        }
+
+        struct ReducePartitioner partitioner;
+        initReducePartitioner(&partitioner, termSketchLoaded ? &termSketch : NULL, NUMBER_OF_PROCESSES - 1, options.reduceVolume);
+        if (termSketchLoaded) {
+            printf("Root -> Estimated %ld postings, balancing the reverse index tasks to %ld postings each\n",
+                   termSketch.total, partitioner.targetVolume);
         }
 
         /**
          * Start the reverse index phase once all other tasks have been successfully completed
+         * The words are streamed from the temporary reverse index directory and grouped into tasks as they are discovered,
+         * followed by the keys of every job channel, which are sent as {job}/{key}
          */
         int numberOfReverseIndexedWords = 0;
-        df = getFileNamesForDirectory(REVERSE_INDEX_TEMP_LOCATION);
+        int numberOfReducedKeys = 0;
+        int numberOfOutstandingWords = 0;
+        struct DirectoryStream * wordStream = openDirectoryStream(REVERSE_INDEX_TEMP_LOCATION, false);
+        int currentJob = -1;
+        if (!wordStream) {
+            printf("%sRoot -> Skipping the reverse index words, moving on to the job channels%s\n", KRED, KNRM);
+            wordStream = openNextJobChannel(&currentJob);
+        }
 
         bool availableWorkers[NUMBER_OF_PROCESSES];
         for (int i = 1; i < NUMBER_OF_PROCESSES; i++) {
             availableWorkers[i] = true;
         }
 
-        printf("Root -> Found a number of %d words\nRoot -> Beginning reverse-indexing\n", df.numberOfFiles);
+        printf("Root -> Beginning reverse-indexing\n");
 
-        while(numberOfReverseIndexedWords != df.numberOfFiles) {
+        while(wordStream || hasReduceTasks(&partitioner) || numberOfOutstandingWords > 0) {
             char processedFile[FILENAME_MAX];
-            MPI_Irecv(processedFile, FILENAME_MAX, MPI_CHAR, MPI_ANY_SOURCE, TASK_REVERSE_INDEX_WORD, MPI_COMM_WORLD, &req);
+            MPI_Irecv(processedFile, FILENAME_MAX, MPI_CHAR, MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &req);
             MPI_Test(&req, &flag, &status);
 
             if (flag == true) {
-                availableWorkers[status.MPI_SOURCE] = true;
+                // Acknowledgements of workers that never got a task in the previous phase are ignored
+                if (status.MPI_TAG == TASK_REVERSE_INDEX_WORD ||
+                    status.MPI_TAG == TASK_REVERSE_INDEX_PART ||
+                    status.MPI_TAG == TASK_REVERSE_INDEX_MERGE ||
+                    status.MPI_TAG == TASK_JOB_REDUCE) {
+                    availableWorkers[status.MPI_SOURCE] = true;
+                    numberOfOutstandingWords--;
+
+                    int messageLength;
+                    MPI_Get_count(&status, MPI_CHAR, &messageLength);
+                    recordTaskCompleted(&metrics, status.MPI_SOURCE, status.MPI_TAG, processedFile, messageLength);
+                }
+
+                // The merge task of a split word is queued once all of its parts are reverse-indexed
+                if (status.MPI_TAG == TASK_REVERSE_INDEX_PART) {
+                    completeReducePart(&partitioner, processedFile);
+                }
             } else {
                 MPI_Cancel(&req);
                 MPI_Request_free(&req);
             }
 
             int availableWorkerId = 0;
-            if ((availableWorkerId = getAvailableWorkerId(availableWorkers, NUMBER_OF_PROCESSES)) != 0) {
-                MPI_Isend(df.filenames[numberOfReverseIndexedWords]->d_name,
-                        strlen(df.filenames[numberOfReverseIndexedWords]->d_name) + 1,
-                        MPI_CHAR,
-                        availableWorkerId,
-                        TASK_REVERSE_INDEX_WORD,
-                        MPI_COMM_WORLD,
-                        &req);
+            while ((availableWorkerId = getAvailableWorkerId(availableWorkers, NUMBER_OF_PROCESSES)) != 0) {
+                struct ReduceTask task;
+
+                if (!getNextReduceTask(&partitioner, &task)) {
+                    if (!wordStream) { break; }
+
+                    char * words[DIRECTORY_BATCH_SIZE];
+                    int numberOfWords = readDirectoryBatch(wordStream, words, DIRECTORY_BATCH_SIZE, NULL);
+                    for (int i = 0; i < numberOfWords; i++) {
+                        if (currentJob >= 0) {
+                            char taskName[FILENAME_MAX];
+                            snprintf(taskName, FILENAME_MAX, "%s/%s", getMapReduceJob(currentJob)->name, words[i]);
+                            queueReduceTask(&partitioner, TASK_JOB_REDUCE, taskName);
+                            numberOfReducedKeys++;
+                        } else {
+                            addReduceWord(&partitioner, words[i]);
+                            numberOfReverseIndexedWords++;
+                        }
+                        free(words[i]);
+                    }
+
+                    if (numberOfWords == 0) {
+                        closeDirectoryStream(wordStream);
+                        wordStream = NULL;
+
+                        // The last batch of words is not full, it is queued once there are no more words
+                        flushReduceBatch(&partitioner);
+
+                        // Move on to the channel of the next job once all the words of the current source are sent
+                        wordStream = openNextJobChannel(&currentJob);
+                    }
+                    continue;
+                }
+
+                // Blocking send, since the task message is released right after
+                MPI_Send(task.message,
+                         strlen(task.message) + 1,
+                         MPI_CHAR,
+                         availableWorkerId,
+                         task.tag,
+                         MPI_COMM_WORLD);
+                free(task.message);
 
+                recordTaskDispatched(&metrics, availableWorkerId, task.tag);
                 availableWorkers[availableWorkerId] = false;
-                numberOfReverseIndexedWords++;
+                numberOfOutstandingWords++;
             }
+
+            pollMetrics(&metrics, 2, NULL, 0, getNumberOfQueuedReduceTasks(&partitioner));
+        }
+
+        if (termSketchLoaded) {
+            printf("%sROOT -> Balanced the words into %d tasks, %d heavy words were split%s\n", KMAG,
+                   partitioner.totalBatches, partitioner.totalSplitWords, KNRM);
+            freeFrequencySketch(&termSketch);
         }
+        freeReducePartitioner(&partitioner);
 
-        for (int i = 0; i < df.numberOfFiles; i++) {
-            free(df.filenames[i]);
+        printf("%sROOT -> Finished reverse indexing a number of %d words%s\n", KMAG, numberOfReverseIndexedWords, KNRM);
+        if (getNumberOfMapReduceJobs() > 0) {
+            printf("%sROOT -> Reduced a number of %d job keys%s\n", KMAG, numberOfReducedKeys, KNRM);
         }
 
-        printf("%sROOT -> Finished reverse indexing%s\n", KMAG, KNRM);
+        // All the reduce tasks are reported at this point, so every segment is complete
+        if (options.buildLexicon) {
+            if (buildLexiconFromSegments(LEXICON_SEGMENTS_LOCATION, LEXICON_LOCATION)) {
+                printf("%sROOT -> Built the lexicon of %d words%s\n", KMAG, numberOfReverseIndexedWords, KNRM);
+            } else {
+                printf("%sROOT -> Could not build the lexicon%s\n", KRED, KNRM);
+            }
+        }
 
         for(int processRank = 1; processRank < NUMBER_OF_PROCESSES; processRank++) {
             printf("SENDING KILL TO %d\n", processRank);
@@ -218,11 +1729,19 @@ int main(int argc, char ** argv) {
             MPI_Request kill_req;
             MPI_Isend(NULL, 0, MPI_CHAR, processRank, TASK_KILL, MPI_COMM_WORLD, &kill_req);
         }
+
+        // The final state of the run stays in the textfile for the last scrape
+        updateMetrics(&metrics, 3, NULL, 0, 0);
+        exportMetrics(&metrics);
+        freeMetrics(&metrics);
     }
 
     if (CURRENT_RANK != ROOT) {
         int tag = 0;
-        char * fileName;
+        char fileName[MAX_TASK_MESSAGE_SIZE];
+
+        struct WorkerState worker;
+        initWorkerState(&worker, CURRENT_RANK, &options, &shuffle, true);
 
         MPI_Request ack_req;
         MPI_Isend(NULL, 0, MPI_CHAR, ROOT, TASK_ACK, MPI_COMM_WORLD, &ack_req);
@@ -233,261 +1752,26 @@ int main(int argc, char ** argv) {
             int messageReceived;
             MPI_Request taskRequest;
 
-            fileName = (char *)malloc(FILENAME_MAX);
-            MPI_Irecv(fileName, FILENAME_MAX, MPI_CHAR, ROOT, MPI_ANY_TAG, MPI_COMM_WORLD, &taskRequest);
+            MPI_Irecv(fileName, MAX_TASK_MESSAGE_SIZE, MPI_CHAR, ROOT, MPI_ANY_TAG, MPI_COMM_WORLD, &taskRequest);
 
             MPI_Test(&taskRequest, &messageReceived, &status);
             if (messageReceived == false) {
-                free(fileName);
                 MPI_Cancel(&taskRequest);
                 MPI_Request_free(&taskRequest);
                 continue;
             }
 
-            switch(status.MPI_TAG) {
-                case TASK_PROCESS_WORDS: {
-                    MPI_Request req;
-
-                    char * fullPath = buildFilePath(FILES_DIRECTORY, fileName);
-
-                    FILE * file = fopen(fullPath, "r");
-                    if (!file) {
-                        printf("%sWorker %d -> Could not open file at \"%s\"!%s\n", KRED, CURRENT_RANK, fullPath, KNRM);
-                        free(fullPath);
-                        break;
-                    }
-
-                    char * tempDirName = buildFilePath(TEMP_DIRNAME, fileName);
-                    mkdir(tempDirName, 0777);
-
-                    printf("%sWorker %d -> Opened file \"%s\"%s\n", KBLU, CURRENT_RANK, fullPath, KNRM);
-                    free(fullPath);
-                    char * word;
-                    int numberOfWords = 0;
-                    while ((word = readWord(file)) != NULL) {
-                        // Create a file with format "{fileName}.{timestamp}"
-                        FILE * written;
-                        char * pathToWrite;
-                        char * fileToWrite;
-
-                        // For loop used to try to write the file to the disk.
-                        // Creation of the file might fail if the timestamp is the previous one
-                        // This is a safety measure, even if the chances of that happening are slim
-                        for (int i = 0; i < 5; i++) {
-                            char timestamp[42];
-                            sprintf(timestamp, "%ld", getCurrentTimestamp());
-                            fileToWrite = (char *)malloc(strlen(timestamp) + strlen(word) + 2);
-                            sprintf(fileToWrite, "%s_%s", word, timestamp);
-                            pathToWrite = buildFilePath(tempDirName, fileToWrite);
-
-                            written = createFile(pathToWrite);
-
-                            free(fileToWrite);
-                            free(pathToWrite);
-
-                            if (written != NULL) {
-                                break;
-                            }
-                        }
-
-                        numberOfWords++;
-
-                        free(word);
-
-                        if (written != NULL) {
-                            fclose(written);
-                        }
-                    }
-
-                    printf("%sWorker %d -> Found %d words in file \"%s\"%s\n", KBLU, CURRENT_RANK, numberOfWords, fileName, KNRM);
-
-                    free(tempDirName);
-                    fclose(file);
-
-                    MPI_Isend(fileName,
-                             strlen(fileName) + 1,
-                             MPI_CHAR,
-                             ROOT,
-                             TASK_PROCESS_WORDS,
-                             MPI_COMM_WORLD,
-                             &req);
-                    break;
-                }
-                case TASK_INDEX_FILE: {
-                    MPI_Request req;
-
-                    char * directoryPath = buildFilePath(TEMP_DIRNAME, fileName);
-                    struct DirectoryFiles df = getFileNamesForDirectory(directoryPath);
-                    if (df.numberOfFiles == 0) {
-                        printf("%sWorker %d -> No words found in directory %s%s\n", KRED, CURRENT_RANK, directoryPath, KNRM);
-                        free(directoryPath);
-
-                        MPI_Isend(fileName,
-                                 strlen(fileName) + 1,
-                                 MPI_CHAR,
-                                 ROOT,
-                                 TASK_INDEX_FILE,
-                                 MPI_COMM_WORLD,
-                                 &req);
-                        break;
-                    }
-
-                    char * directIndexFilePath = buildFilePath(DIRECT_INDEX_LOCATION, fileName);
-                    fclose(createFile(directIndexFilePath));
-
-                    FILE * file = fopen(directIndexFilePath, "a");
-                    if (!file) {
-                        printf("%sWorker %d -> Could not write direct-index file %s%s\n", KRED, CURRENT_RANK, directIndexFilePath, KNRM);
-
-                        MPI_Isend(fileName,
-                                 strlen(fileName) + 1,
-                                 MPI_CHAR,
-                                 ROOT,
-                                 TASK_INDEX_FILE,
-                                 MPI_COMM_WORLD,
-                                 &req);
-                        break;
-                    }
-
-                    char * word;
-                    char * lastWord = strtok(df.filenames[0]->d_name, "_");
-                    int wordCount = 1;
-
-                    for(int i = 0; i < df.numberOfFiles; i++) {
-                        word = strtok(df.filenames[i]->d_name, "_");
-
-                        if (strcmp(lastWord, word) == 0) {
-                            wordCount++;
-                        } else {
-                            fprintf(file, "%s %d\n", lastWord, wordCount);
-
-                            lastWord = word;
-                            wordCount = 1;
-                        }
-                    }
-
-                    printf("%sWorker %d -> Indexed file %s%s\n", KGRN, CURRENT_RANK, fileName, KNRM);
-
-                    fclose(file);
-
-                    for (int i = 0; i < df.numberOfFiles; i++) {
-                        free(df.filenames[i]);
-                    }
-
-                    MPI_Isend(fileName,
-                             strlen(fileName) + 1,
-                             MPI_CHAR,
-                             ROOT,
-                             TASK_INDEX_FILE,
-                             MPI_COMM_WORLD,
-                             &req);
-
-                    break;
-                }
-
-                case TASK_REVERSE_INDEX_FILE: {
-                    MPI_Request req;
-
-                    printf("%sWorker %d -> Received file %s for reverse-indexing%s\n", KYEL, CURRENT_RANK, fileName, KNRM);
-
-                    char * filePath = buildFilePath(DIRECT_INDEX_LOCATION, fileName);
-                    FILE * directIndexFile = fopen(filePath, "r");
-                    if (!directIndexFile) {
-                        printf("%sWorker %d -> Could not read direct-index file %s%s\n", KRED, CURRENT_RANK, filePath, KNRM);
-
-                        MPI_Isend(fileName,
-                                 strlen(fileName) + 1,
-                                 MPI_CHAR,
-                                 ROOT,
-                                 TASK_REVERSE_INDEX_FILE,
-                                 MPI_COMM_WORLD,
-                                 &req);
-                        break;
-                    }
-                    free(filePath);
-
-                    char * word;
-                    char * numberOfApparitions;
-                    while ((word = readWord(directIndexFile)) != NULL &&
-                        (numberOfApparitions = readWord(directIndexFile)) != NULL) {
-
-                        char * wordPath = buildFilePath(REVERSE_INDEX_TEMP_LOCATION, word);
-                        mkdir(wordPath, 0777);
-
-                        char fileNameToWrite[FILENAME_MAX];
-                        sprintf(fileNameToWrite, "%s_%s_%ld", fileName, numberOfApparitions, getCurrentTimestamp());
-                        filePath = buildFilePath(wordPath, fileNameToWrite);
-
-                        FILE * wordFile = fopen(filePath, "a");
-                        fclose(wordFile);
-
-                        free(wordPath);
-                        free(word);
-                        free(numberOfApparitions);
-                    }
-
-                    MPI_Isend(fileName,
-                             strlen(fileName) + 1,
-                             MPI_CHAR,
-                             ROOT,
-                             TASK_REVERSE_INDEX_FILE,
-                             MPI_COMM_WORLD,
-                             &req);
-
-                    fclose(directIndexFile);
-                    break;
-                }
-
-                case TASK_REVERSE_INDEX_WORD: {
-                    MPI_Request req;
-                    char * wordPath = buildFilePath(REVERSE_INDEX_TEMP_LOCATION, fileName);
-                    struct DirectoryFiles df = getFileNamesForDirectory(wordPath);
-
-                    FILE * wordFile = fopen(buildFilePath(REVERSE_INDEX_LOCATION, fileName), "a");
-                    if (!wordFile) {
-                        printf("%sWorker %d -> Could not write reverse-index file %s%s\n", KRED, CURRENT_RANK, fileName, KNRM);
-
-                        MPI_Isend(fileName,
-                                  strlen(fileName) + 1,
-                                  MPI_CHAR,
-                                  ROOT,
-                                  TASK_REVERSE_INDEX_FILE,
-                                  MPI_COMM_WORLD,
-                                  &req);
-                        break;
-                    }
-
-                    for (int i = 0; i < df.numberOfFiles; i++) {
-                        char *parentFile = strtok(df.filenames[i]->d_name, "_");
-                        char *numberOfApparitions = strtok(NULL, "_");
-                        fprintf(wordFile, "%s %s\n", parentFile, numberOfApparitions);
-                    }
-
-                    for (int i = 0; i < df.numberOfFiles; i++) {
-                        free(df.filenames[i]);
-                    }
-
-                    fclose(wordFile);
-                    free(wordPath);
-
-                    MPI_Isend(fileName,
-                              strlen(fileName) + 1,
-                              MPI_CHAR,
-                              ROOT,
-                              TASK_REVERSE_INDEX_WORD,
-                              MPI_COMM_WORLD,
-                              &req);
-
-                    break;
-                }
-            }
+            int taskLength;
+            MPI_Get_count(&status, MPI_CHAR, &taskLength);
+            executeTask(&worker, status.MPI_TAG, fileName, taskLength);
 
-            free(fileName);
             tag = status.MPI_TAG;
         } while (tag != TASK_KILL);
 
+        freeWorkerState(&worker);
     }
 
+    freeSharedShuffle(&shuffle);
     MPI_Finalize();
 
     return 0;
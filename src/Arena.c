@@ -0,0 +1,177 @@
+/**
+ * Function library for a bump allocator whose allocations are all released at once
+ *
+ * Functions that take an arena fall back to malloc when they are given a NULL arena,
+ * in which case the caller has to free the result as usual
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "../defs/Arena.h"
+
+#define ARENA_ALIGNMENT 16
+
+// The largest block kept by an arena across resets, so that a single huge task does not pin its memory forever
+#define ARENA_MAX_RETAINED_SIZE (64 * 1024 * 1024)
+
+/**
+ * Allocate a new block and make it the current block of the arena
+ * @param arena The arena to grow
+ * @param minimumSize The minimum number of usable bytes of the block
+ * @return The new block or NULL if it could not be allocated
+ */
+static struct ArenaBlock * addArenaBlock(struct Arena * arena, size_t minimumSize) {
+    size_t size = arena->blockSize;
+    while (size < minimumSize) {
+        size *= 2;
+    }
+
+    struct ArenaBlock * block = (struct ArenaBlock *)malloc(sizeof(struct ArenaBlock) + size);
+    if (!block) {
+        return NULL;
+    }
+
+    block->previous = arena->current;
+    block->size = size;
+    block->used = 0;
+    arena->current = block;
+
+    return block;
+}
+
+/**
+ * Initialize an empty arena
+ * @param arena The arena to initialize
+ * @param blockSize The size of the first block, the following blocks are at least as big
+ */
+void initArena(struct Arena * arena, size_t blockSize) {
+    memset(arena, 0, sizeof(struct Arena));
+    arena->blockSize = blockSize ? blockSize : DEFAULT_ARENA_BLOCK_SIZE;
+}
+
+/**
+ * Allocate memory, from the arena if one is given or with malloc otherwise
+ * @param arena The arena to allocate from, or NULL
+ * @param size The number of bytes to allocate
+ * @return The allocated memory, aligned for any type
+ */
+void * arenaAllocate(struct Arena * arena, size_t size) {
+    if (!arena) {
+        return malloc(size);
+    }
+
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    struct ArenaBlock * block = arena->current;
+    if (!block || block->size - block->used < size) {
+        block = addArenaBlock(arena, size);
+        if (!block) {
+            return NULL;
+        }
+    }
+
+    void * memory = block->data + block->used;
+    block->used += size;
+
+    arena->usedBytes += size;
+    arena->numberOfAllocations++;
+    if (arena->usedBytes > arena->peakBytes) {
+        arena->peakBytes = arena->usedBytes;
+    }
+
+    return memory;
+}
+
+/**
+ * Duplicate a string, in the arena if one is given or with malloc otherwise
+ * @param arena The arena to allocate from, or NULL
+ * @param string The string to duplicate
+ * @return The copy of the string
+ */
+char * arenaDuplicate(struct Arena * arena, const char * string) {
+    size_t length = strlen(string) + 1;
+    char * copy = (char *)arenaAllocate(arena, length);
+
+    if (copy) {
+        memcpy(copy, string, length);
+    }
+
+    return copy;
+}
+
+/**
+ * Remember the current position of an arena
+ * @param arena The arena
+ * @return The current position
+ */
+struct ArenaMark markArena(struct Arena * arena) {
+    struct ArenaMark mark;
+    mark.block = arena->current;
+    mark.used = arena->current ? arena->current->used : 0;
+    mark.usedBytes = arena->usedBytes;
+
+    return mark;
+}
+
+/**
+ * Release everything that was allocated after a given position, the blocks added since then are freed
+ * @param arena The arena
+ * @param mark The position returned by markArena
+ */
+void releaseArena(struct Arena * arena, struct ArenaMark mark) {
+    while (arena->current && arena->current != mark.block) {
+        struct ArenaBlock * previous = arena->current->previous;
+        free(arena->current);
+        arena->current = previous;
+    }
+
+    if (arena->current) {
+        arena->current->used = mark.used;
+    }
+    arena->usedBytes = mark.usedBytes;
+}
+
+/**
+ * Release all the allocations of an arena and reset its statistics
+ * When the last use needed several blocks, they are replaced by a single block big enough for all of them
+ * (up to ARENA_MAX_RETAINED_SIZE), so that the next use of a similar size does not allocate at all
+ * @param arena The arena to reset
+ */
+void resetArena(struct Arena * arena) {
+    size_t totalSize = 0;
+    int numberOfBlocks = 0;
+
+    for (struct ArenaBlock * block = arena->current; block; block = block->previous) {
+        totalSize += block->size;
+        numberOfBlocks++;
+    }
+
+    if (numberOfBlocks > 1) {
+        freeArena(arena);
+        arena->blockSize = totalSize < ARENA_MAX_RETAINED_SIZE ? totalSize : ARENA_MAX_RETAINED_SIZE;
+        addArenaBlock(arena, arena->blockSize);
+    } else if (arena->current) {
+        arena->current->used = 0;
+    }
+
+    arena->usedBytes = 0;
+    arena->peakBytes = 0;
+    arena->numberOfAllocations = 0;
+}
+
+/**
+ * Free all the blocks of an arena
+ * @param arena The arena to free
+ */
+void freeArena(struct Arena * arena) {
+    while (arena->current) {
+        struct ArenaBlock * previous = arena->current->previous;
+        free(arena->current);
+        arena->current = previous;
+    }
+
+    arena->usedBytes = 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * Function library for the jobs that ship with the MapReduce algorithm
+ *
+ *  - document-length: the number of words of every input file
+ *  - vocabulary-size: the number of distinct words of every input file
+ *  - bigrams: the number of appearances of every pair of consecutive words, stored as {first}+{second}
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../defs/BuiltinJobs.h"
+#include "../defs/MapReduceJob.h"
+#include "../defs/WordCounter.h"
+#include "../defs/FileOperations.h"
+#include "../defs/Logging.h"
+
+/**
+ * Per-file state shared by the built-in jobs
+ */
+struct BuiltinJobState {
+    char * fileName;
+    long numberOfWords;
+    char previousWord[MAX_WORD_LENGTH + 1];
+    struct WordCounter counter;
+};
+
+/**
+ * Create the state of a built-in job for a new input file
+ * @param fileName The name under which the input file is stored
+ * @return The created state
+ */
+static void * beginBuiltinJobFile(char * fileName) {
+    struct BuiltinJobState * state = (struct BuiltinJobState *)calloc(1, sizeof(struct BuiltinJobState));
+    state->fileName = strdup(fileName);
+    initWordCounter(&state->counter, 256);
+
+    return state;
+}
+
+/**
+ * Free the state of a built-in job
+ * @param state The state to free
+ */
+static void freeBuiltinJobState(struct BuiltinJobState * state) {
+    freeWordCounter(&state->counter);
+    free(state->fileName);
+    free(state);
+}
+
+/**
+ * Reduce function that adds up all the values of a key
+ * @param accumulated The sum so far
+ * @param value The value to add
+ * @return The new sum
+ */
+static long sumValues(long accumulated, long value) {
+    return accumulated + value;
+}
+
+/**
+ * Count a word of the file
+ * @param state The state of the file
+ * @param word The word that was read
+ */
+static void mapDocumentLength(void * state, char * word) {
+    (void)word;
+    ((struct BuiltinJobState *)state)->numberOfWords++;
+}
+
+/**
+ * Emit the number of words of the file, keyed by the file name
+ * @param state The state of the file
+ * @param emit The emit function
+ * @param emitContext The context to pass to the emit function
+ */
+static void endDocumentLength(void * state, EmitFunction emit, void * emitContext) {
+    struct BuiltinJobState * jobState = (struct BuiltinJobState *)state;
+
+    emit(emitContext, jobState->fileName, jobState->numberOfWords);
+    freeBuiltinJobState(jobState);
+}
+
+/**
+ * Remember a word of the file
+ * @param state The state of the file
+ * @param word The word that was read
+ */
+static void mapVocabularySize(void * state, char * word) {
+    incrementWord(&((struct BuiltinJobState *)state)->counter, word, 1);
+}
+
+/**
+ * Emit the number of distinct words of the file, keyed by the file name
+ * @param state The state of the file
+ * @param emit The emit function
+ * @param emitContext The context to pass to the emit function
+ */
+static void endVocabularySize(void * state, EmitFunction emit, void * emitContext) {
+    struct BuiltinJobState * jobState = (struct BuiltinJobState *)state;
+
+    emit(emitContext, jobState->fileName, jobState->counter.size);
+    freeBuiltinJobState(jobState);
+}
+
+/**
+ * Count the pair formed by the previous word and the given one
+ * @param state The state of the file
+ * @param word The word that was read
+ */
+static void mapBigrams(void * state, char * word) {
+    struct BuiltinJobState * jobState = (struct BuiltinJobState *)state;
+
+    if (jobState->previousWord[0] != '\0') {
+        char bigram[FILENAME_MAX];
+        snprintf(bigram, FILENAME_MAX, "%s+%s", jobState->previousWord, word);
+        incrementWord(&jobState->counter, bigram, 1);
+    }
+
+    // The previous word is kept in the state, instead of a copy allocated for every word
+    snprintf(jobState->previousWord, sizeof(jobState->previousWord), "%s", word);
+}
+
+/**
+ * Emit the number of appearances of every pair of consecutive words of the file
+ * @param state The state of the file
+ * @param emit The emit function
+ * @param emitContext The context to pass to the emit function
+ */
+static void endBigrams(void * state, EmitFunction emit, void * emitContext) {
+    struct BuiltinJobState * jobState = (struct BuiltinJobState *)state;
+
+    for (int i = 0; i < jobState->counter.capacity; i++) {
+        struct WordCount * entry = jobState->counter.entries + i;
+        if (entry->word) {
+            emit(emitContext, entry->word, entry->count);
+        }
+    }
+
+    freeBuiltinJobState(jobState);
+}
+
+static struct MapReduceJob builtinJobs[] = {
+    { "document-length", beginBuiltinJobFile, mapDocumentLength, endDocumentLength, sumValues },
+    { "vocabulary-size", beginBuiltinJobFile, mapVocabularySize, endVocabularySize, sumValues },
+    { "bigrams", beginBuiltinJobFile, mapBigrams, endBigrams, sumValues },
+};
+
+/**
+ * Register the built-in jobs with the given names
+ * @param jobNames A comma separated list of job names, e.g. "document-length,bigrams"
+ * @return True or false, whether all the jobs were found and registered
+ */
+bool registerBuiltinJobs(char * jobNames) {
+    bool registered = true;
+    char * names = strdup(jobNames);
+    char * savePointer;
+
+    for (char * name = strtok_r(names, ",", &savePointer); name; name = strtok_r(NULL, ",", &savePointer)) {
+        struct MapReduceJob * job = NULL;
+
+        for (size_t i = 0; i < sizeof(builtinJobs) / sizeof(builtinJobs[0]); i++) {
+            if (strcmp(builtinJobs[i].name, name) == 0) {
+                job = builtinJobs + i;
+            }
+        }
+
+        if (!job) {
+            printf("%sUnknown job %s%s\n", KRED, name, KNRM);
+            registered = false;
+            continue;
+        }
+
+        registered = registerMapReduceJob(job) && registered;
+    }
+
+    free(names);
+    return registered;
+}
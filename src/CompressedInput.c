@@ -0,0 +1,327 @@
+/**
+ * Function library used for reading gzip and zstd compressed input files as plain text streams
+ *
+ * Compressed files are wrapped in a FILE stream with fopencookie, so the data is decompressed on demand
+ * straight into the stream buffer that readWord consumes, without temporary files
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "../defs/CompressedInput.h"
+#include "../defs/Utils.h"
+#include "../defs/Logging.h"
+
+#ifdef MAPREDUCE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef MAPREDUCE_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#define COMPRESSED_BUFFER_SIZE 65536
+
+/**
+ * State of a compressed stream: the underlying file, the compressed bytes not consumed yet,
+ * whether the last gzip member or zstd frame read was complete, and the decompressor of the detected format
+ */
+struct CompressedInput {
+    FILE * file;
+    struct InputStatistics * statistics;
+    unsigned char * buffer;
+    size_t bufferPosition;
+    size_t bufferLength;
+    bool finished;
+#ifdef MAPREDUCE_HAVE_ZLIB
+    z_stream zlibStream;
+#endif
+#ifdef MAPREDUCE_HAVE_ZSTD
+    ZSTD_DStream * zstdStream;
+#endif
+};
+
+/**
+ * Refill the compressed buffer from the underlying file once it is fully consumed
+ * @param input The compressed stream
+ * @return True or false, whether there are compressed bytes to consume
+ */
+static bool refillCompressedBuffer(struct CompressedInput * input) {
+    if (input->bufferPosition < input->bufferLength) {
+        return true;
+    }
+
+    input->bufferLength = fread(input->buffer, 1, COMPRESSED_BUFFER_SIZE, input->file);
+    input->bufferPosition = 0;
+    input->statistics->compressedBytes += input->bufferLength;
+
+    return input->bufferLength > 0;
+}
+
+#ifdef MAPREDUCE_HAVE_ZLIB
+/**
+ * Read callback of gzip streams, concatenated gzip members are read one after the other
+ * @param cookie The compressed stream
+ * @param destination The stream buffer to decompress into
+ * @param size The size of the stream buffer
+ * @return The number of decompressed bytes, 0 at the end of the file, -1 on error
+ */
+static ssize_t readGzip(void * cookie, char * destination, size_t size) {
+    struct CompressedInput * input = (struct CompressedInput *)cookie;
+    int64_t start = getCurrentTimestamp();
+
+    input->zlibStream.next_out = (Bytef *)destination;
+    input->zlibStream.avail_out = (uInt)size;
+
+    while (input->zlibStream.avail_out > 0 && !input->finished) {
+        // The file ended in the middle of a gzip member, the bytes decompressed so far are returned first
+        if (!refillCompressedBuffer(input)) {
+            if (input->zlibStream.avail_out < size) {
+                break;
+            }
+            printf("%sCould not decompress gzip input: the file is truncated%s\n", KRED, KNRM);
+            input->finished = true;
+            return -1;
+        }
+
+        input->zlibStream.next_in = input->buffer + input->bufferPosition;
+        input->zlibStream.avail_in = (uInt)(input->bufferLength - input->bufferPosition);
+
+        int result = inflate(&input->zlibStream, Z_NO_FLUSH);
+        input->bufferPosition = input->bufferLength - input->zlibStream.avail_in;
+
+        if (result == Z_STREAM_END) {
+            // Another gzip member may follow the one that just ended
+            input->finished = !refillCompressedBuffer(input) || inflateReset(&input->zlibStream) != Z_OK;
+        } else if (result != Z_OK && !(result == Z_BUF_ERROR && input->zlibStream.avail_in == 0)) {
+            printf("%sCould not decompress gzip input: %s%s\n", KRED, input->zlibStream.msg ? input->zlibStream.msg : "", KNRM);
+            return -1;
+        }
+    }
+
+    size_t produced = size - input->zlibStream.avail_out;
+    input->statistics->decompressedBytes += produced;
+    input->statistics->decompressionTime += getCurrentTimestamp() - start;
+
+    return (ssize_t)produced;
+}
+#endif
+
+#ifdef MAPREDUCE_HAVE_ZSTD
+/**
+ * Read callback of zstd streams, all the frames of the file are read one after the other
+ * @param cookie The compressed stream
+ * @param destination The stream buffer to decompress into
+ * @param size The size of the stream buffer
+ * @return The number of decompressed bytes, 0 at the end of the file, -1 on error
+ */
+static ssize_t readZstd(void * cookie, char * destination, size_t size) {
+    struct CompressedInput * input = (struct CompressedInput *)cookie;
+    int64_t start = getCurrentTimestamp();
+
+    ZSTD_outBuffer output = { destination, size, 0 };
+
+    while (output.pos < output.size) {
+        // At the end of the file the decompressor may still hold output of the last frame, which is flushed first
+        bool available = refillCompressedBuffer(input);
+        if (!available && input->finished) {
+            break;
+        }
+
+        ZSTD_inBuffer in = { input->buffer, input->bufferLength, input->bufferPosition };
+        size_t previousPosition = output.pos;
+
+        size_t result = ZSTD_decompressStream(input->zstdStream, &output, &in);
+        input->bufferPosition = in.pos;
+
+        if (ZSTD_isError(result)) {
+            printf("%sCould not decompress zstd input: %s%s\n", KRED, ZSTD_getErrorName(result), KNRM);
+            return -1;
+        }
+
+        // A frame is complete once the decompressor does not expect more input for it
+        input->finished = result == 0;
+
+        // The file ended in the middle of a frame, the bytes decompressed so far are returned first
+        if (!available && !input->finished && output.pos == previousPosition) {
+            if (output.pos > 0) {
+                break;
+            }
+            printf("%sCould not decompress zstd input: the file is truncated%s\n", KRED, KNRM);
+            input->finished = true;
+            return -1;
+        }
+    }
+
+    input->statistics->decompressedBytes += output.pos;
+    input->statistics->decompressionTime += getCurrentTimestamp() - start;
+
+    return (ssize_t)output.pos;
+}
+#endif
+
+/**
+ * Close callback of compressed streams
+ * @param cookie The compressed stream
+ * @return 0 on success, EOF on error
+ */
+static int closeCompressedInput(void * cookie) {
+    struct CompressedInput * input = (struct CompressedInput *)cookie;
+
+#ifdef MAPREDUCE_HAVE_ZLIB
+    if (input->statistics->compression == GzipCompression) {
+        inflateEnd(&input->zlibStream);
+    }
+#endif
+#ifdef MAPREDUCE_HAVE_ZSTD
+    if (input->zstdStream) {
+        ZSTD_freeDStream(input->zstdStream);
+    }
+#endif
+
+    int result = fclose(input->file);
+    free(input->buffer);
+    free(input);
+
+    return result;
+}
+
+/**
+ * Detect the compression of a file by its magic bytes
+ * @param magic The first bytes of the file
+ * @param length The number of bytes available
+ * @return The detected compression
+ */
+static enum InputCompression detectCompression(const unsigned char * magic, size_t length) {
+    if (length >= 2 && magic[0] == 0x1F && magic[1] == 0x8B) {
+        return GzipCompression;
+    }
+
+    if (length >= 4 && magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD) {
+        return ZstdCompression;
+    }
+
+    return NoCompression;
+}
+
+/**
+ * Open an input file for reading, decompressing it on the fly when it is gzip or zstd compressed
+ * @param path The path of the input file
+ * @param statistics Where the format and the read statistics are stored, it must outlive the returned stream
+ * @return A stream of the plain text of the file or NULL in case it could not be opened
+ */
+FILE * openInputFile(char * path, struct InputStatistics * statistics) {
+    memset(statistics, 0, sizeof(struct InputStatistics));
+
+    FILE * file = fopen(path, "r");
+    if (!file) {
+        return NULL;
+    }
+
+    unsigned char magic[4];
+    size_t magicLength = fread(magic, 1, sizeof(magic), file);
+    rewind(file);
+
+    statistics->compression = detectCompression(magic, magicLength);
+    if (statistics->compression == NoCompression) {
+        struct stat fileStat;
+        if (fstat(fileno(file), &fileStat) == 0) {
+            statistics->compressedBytes = statistics->decompressedBytes = fileStat.st_size;
+        }
+
+        return file;
+    }
+
+    struct CompressedInput * input = (struct CompressedInput *)calloc(1, sizeof(struct CompressedInput));
+    input->file = file;
+    input->statistics = statistics;
+    input->buffer = (unsigned char *)malloc(COMPRESSED_BUFFER_SIZE);
+
+    cookie_io_functions_t functions;
+    memset(&functions, 0, sizeof(functions));
+    functions.close = closeCompressedInput;
+
+    switch (statistics->compression) {
+        case GzipCompression:
+#ifdef MAPREDUCE_HAVE_ZLIB
+            // 15 + 32 lets zlib parse the gzip header itself
+            if (inflateInit2(&input->zlibStream, 15 + 32) == Z_OK) {
+                functions.read = readGzip;
+            }
+#endif
+            break;
+        case ZstdCompression:
+#ifdef MAPREDUCE_HAVE_ZSTD
+            input->zstdStream = ZSTD_createDStream();
+            if (input->zstdStream && !ZSTD_isError(ZSTD_initDStream(input->zstdStream))) {
+                functions.read = readZstd;
+            }
+#endif
+            break;
+        default:
+            break;
+    }
+
+    if (!functions.read) {
+        printf("%sCould not decompress %s, %s support is not available%s\n", KRED, path,
+               getCompressionName(statistics->compression), KNRM);
+        statistics->compression = NoCompression;
+        closeCompressedInput(input);
+        return NULL;
+    }
+
+    FILE * stream = fopencookie(input, "r", functions);
+    if (!stream) {
+        closeCompressedInput(input);
+    }
+
+    return stream;
+}
+
+/**
+ * Get the name of a compression format, for logging
+ * @param compression The compression format
+ * @return The name of the format
+ */
+const char * getCompressionName(enum InputCompression compression) {
+    switch (compression) {
+        case GzipCompression:
+            return "gzip";
+        case ZstdCompression:
+            return "zstd";
+        default:
+            return "plain";
+    }
+}
+
+/**
+ * Add the statistics of a compressed input file to the totals of a worker
+ * @param totals The totals, the compression format is not used
+ * @param statistics The statistics of the file
+ */
+void addInputStatistics(struct InputStatistics * totals, struct InputStatistics * statistics) {
+    totals->compressedBytes += statistics->compressedBytes;
+    totals->decompressedBytes += statistics->decompressedBytes;
+    totals->decompressionTime += statistics->decompressionTime;
+}
+
+/**
+ * Get the decompression throughput of a compressed input file, or of the totals of a worker
+ * @param statistics The statistics of the file
+ * @return The number of decompressed megabytes per second
+ */
+double getDecompressionThroughput(struct InputStatistics * statistics) {
+    if (statistics->decompressionTime <= 0) {
+        return 0.0;
+    }
+
+    return (double)statistics->decompressedBytes / (double)statistics->decompressionTime;
+}
@@ -0,0 +1,215 @@
+/**
+ * Function library for a streaming directory enumerator built on getdents64
+ *
+ * Entries are handed out in the order the filesystem returns them, without sorting,
+ * so the caller can start working on the first batch while the rest of the directory is still unread
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include "../defs/DirectoryStream.h"
+#include "../defs/Logging.h"
+
+#define DIRECTORY_STREAM_BUFFER_SIZE 32768
+
+/**
+ * The record layout returned by the getdents64 system call
+ */
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+/**
+ * Push a newly opened directory on top of the stream stack
+ * @param stream The stream to push to
+ * @param fd The file descriptor of the opened directory
+ * @param relativePath The path of the directory relative to the stream root, the stack takes ownership of it
+ * @return True or false, whether the directory could be pushed
+ */
+static bool pushDirectoryLevel(struct DirectoryStream * stream, int fd, char * relativePath) {
+    if (stream->depth == stream->capacity) {
+        int capacity = stream->capacity ? stream->capacity * 2 : 4;
+        struct DirectoryStreamLevel * levels = realloc(stream->levels, capacity * sizeof(struct DirectoryStreamLevel));
+        if (!levels) {
+            return false;
+        }
+
+        stream->levels = levels;
+        stream->capacity = capacity;
+    }
+
+    struct DirectoryStreamLevel * level = stream->levels + stream->depth;
+    level->buffer = (char *)malloc(DIRECTORY_STREAM_BUFFER_SIZE);
+    if (!level->buffer) {
+        return false;
+    }
+
+    level->fd = fd;
+    level->relativePath = relativePath;
+    level->bufferPosition = level->bufferLength = 0;
+    stream->depth++;
+
+    return true;
+}
+
+/**
+ * Close the directory on top of the stream stack
+ * @param stream The stream to pop from
+ */
+static void popDirectoryLevel(struct DirectoryStream * stream) {
+    struct DirectoryStreamLevel * level = stream->levels + --stream->depth;
+
+    close(level->fd);
+    free(level->relativePath);
+    free(level->buffer);
+}
+
+/**
+ * Join a relative directory path and an entry name, an empty directory path yields the name itself
+ * @param relativePath The relative path of the parent directory
+ * @param name The name of the entry
+ * @param arena The arena to allocate the path from, or NULL to allocate it with malloc
+ * @return The joined relative path
+ */
+static char * joinRelativePath(char * relativePath, char * name, struct Arena * arena) {
+    size_t prefixLength = strlen(relativePath);
+    char * path = (char *)arenaAllocate(arena, prefixLength + strlen(name) + 2);
+
+    if (prefixLength == 0) {
+        strcpy(path, name);
+    } else {
+        sprintf(path, "%s/%s", relativePath, name);
+    }
+
+    return path;
+}
+
+/**
+ * Open a directory for streaming enumeration
+ * @param directoryName The path of the directory to enumerate
+ * @param recursive Whether subdirectories are descended into instead of being returned as entries
+ * @return A pointer to the stream or NULL in case the directory could not be opened
+ */
+struct DirectoryStream * openDirectoryStream(char * directoryName, bool recursive) {
+    int fd = open(directoryName, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) {
+        printf("%sCould not open directory %s%s\n", KRED, directoryName, KNRM);
+        return NULL;
+    }
+
+    struct DirectoryStream * stream = (struct DirectoryStream *)calloc(1, sizeof(struct DirectoryStream));
+    stream->recursive = recursive;
+
+    char * relativePath = (char *)calloc(1, 1);
+    if (!pushDirectoryLevel(stream, fd, relativePath)) {
+        close(fd);
+        free(relativePath);
+        free(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+/**
+ * Read the next batch of entries from a directory stream
+ * '.' and '..' are never returned, in recursive mode only non-directory entries are returned,
+ * with their path relative to the stream root
+ * @param stream The stream to read from
+ * @param names The array where the entry names are stored
+ * @param maxNames The maximum number of entries to read
+ * @param arena The arena to allocate the names from, or NULL to allocate them with malloc, in which case
+ * each name must be freed by the caller
+ * @return The number of entries read, 0 once the stream is exhausted
+ */
+int readDirectoryBatch(struct DirectoryStream * stream, char ** names, int maxNames, struct Arena * arena) {
+    int numberOfNames = 0;
+
+    while (numberOfNames < maxNames && stream->depth > 0) {
+        struct DirectoryStreamLevel * level = stream->levels + stream->depth - 1;
+
+        if (level->bufferPosition >= level->bufferLength) {
+            long bytesRead = syscall(SYS_getdents64, level->fd, level->buffer, DIRECTORY_STREAM_BUFFER_SIZE);
+            if (bytesRead <= 0) {
+                if (bytesRead == -1) {
+                    printf("%sCould not read directory entries of \"%s\"%s\n", KRED, level->relativePath, KNRM);
+                }
+                popDirectoryLevel(stream);
+                continue;
+            }
+
+            level->bufferLength = (int)bytesRead;
+            level->bufferPosition = 0;
+        }
+
+        struct LinuxDirent64 * entry = (struct LinuxDirent64 *)(level->buffer + level->bufferPosition);
+        level->bufferPosition += entry->d_reclen;
+
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+
+        if (stream->recursive) {
+            bool isDirectory = entry->d_type == DT_DIR;
+
+            if (entry->d_type == DT_UNKNOWN) {
+                struct stat entryStat;
+                isDirectory = fstatat(level->fd, entry->d_name, &entryStat, AT_SYMLINK_NOFOLLOW) == 0 &&
+                              S_ISDIR(entryStat.st_mode);
+            }
+
+            if (isDirectory) {
+                int fd = openat(level->fd, entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if (fd == -1) {
+                    printf("%sCould not open directory %s%s\n", KRED, entry->d_name, KNRM);
+                    continue;
+                }
+
+                // The level pointer is not valid anymore after the push, since the stack may be reallocated
+                char * relativePath = joinRelativePath(level->relativePath, entry->d_name, NULL);
+                if (!pushDirectoryLevel(stream, fd, relativePath)) {
+                    close(fd);
+                    free(relativePath);
+                }
+                continue;
+            }
+        }
+
+        names[numberOfNames++] = joinRelativePath(level->relativePath, entry->d_name, arena);
+    }
+
+    return numberOfNames;
+}
+
+/**
+ * Close a directory stream and all the directories that are still open
+ * @param stream The stream to close
+ */
+void closeDirectoryStream(struct DirectoryStream * stream) {
+    if (!stream) {
+        return;
+    }
+
+    while (stream->depth > 0) {
+        popDirectoryLevel(stream);
+    }
+
+    free(stream->levels);
+    free(stream);
+}
@@ -10,37 +10,128 @@
 #include <string.h>
 #include <stdbool.h>
 #include "../defs/FileOperations.h"
+#include "../defs/DirectoryStream.h"
 #include "../defs/Logging.h"
 
 /**
- * Get the number of files in a directory and their corresponding file names
+ * Comparator used to sort file names alphabetically
+ * @param a The first file name
+ * @param b The second file name
+ * @return The order of the two file names
+ */
+static int compareFileNames(const void * a, const void * b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/**
+ * Get the number of files in a directory and their corresponding file names, sorted alphabetically
  * @param directoryName The path of the directory for which to get the files
+ * @param arena The arena to allocate the listing from, or NULL to allocate it with malloc
  * @return A struct containing the file names and the number of files
  */
-struct DirectoryFiles getFileNamesForDirectory(char * directoryName) {
+struct DirectoryFiles getFileNamesForDirectory(char * directoryName, struct Arena * arena) {
     struct DirectoryFiles df;
-    df.numberOfFiles = scandir(directoryName, &df.filenames, 0, alphasort);
+    df.filenames = NULL;
+    df.numberOfFiles = 0;
 
-    // The first 2 folders are '.' and '..' and we do not want those
-    df.filenames += 2;
-    df.numberOfFiles -= 2;
+    struct DirectoryStream * stream = openDirectoryStream(directoryName, false);
+    if (!stream) {
+        return df;
+    }
+
+    int capacity = 0;
+    int numberOfNames;
+    char * names[DIRECTORY_BATCH_SIZE];
+
+    while ((numberOfNames = readDirectoryBatch(stream, names, DIRECTORY_BATCH_SIZE, arena)) > 0) {
+        if (df.numberOfFiles + numberOfNames > capacity) {
+            int previousCapacity = capacity;
+            char ** previousNames = df.filenames;
+
+            capacity = (df.numberOfFiles + numberOfNames) * 2;
+            df.filenames = (char **)arenaAllocate(arena, capacity * sizeof(char *));
+            if (previousNames) {
+                memcpy(df.filenames, previousNames, previousCapacity * sizeof(char *));
+            }
+            if (!arena) {
+                free(previousNames);
+            }
+        }
+
+        memcpy(df.filenames + df.numberOfFiles, names, numberOfNames * sizeof(char *));
+        df.numberOfFiles += numberOfNames;
+    }
+    closeDirectoryStream(stream);
+
+    if (df.numberOfFiles > 0) {
+        qsort(df.filenames, df.numberOfFiles, sizeof(char *), compareFileNames);
+    }
 
     return df;
 }
 
+/**
+ * Free the entries of a directory listing allocated with malloc, and the listing itself
+ * @param df The directory listing to free
+ */
+void freeDirectoryFiles(struct DirectoryFiles * df) {
+    for (int i = 0; i < df->numberOfFiles; i++) {
+        free(df->filenames[i]);
+    }
+
+    free(df->filenames);
+    df->filenames = NULL;
+    df->numberOfFiles = 0;
+}
+
 /**
  * Create a file path by concatenating the 2 given paths into a single one
  * @param directoryName The first part of the path
  * @param fileName The other part of the path
+ * @param arena The arena to allocate the path from, or NULL to allocate it with malloc
  * @return The joined path
  */
-char * buildFilePath(char * directoryName, char * fileName) {
-    char * filePath = (char *)malloc(strlen(directoryName) + strlen(fileName) + 2);
+char * buildFilePath(char * directoryName, char * fileName, struct Arena * arena) {
+    char * filePath = (char *)arenaAllocate(arena, strlen(directoryName) + strlen(fileName) + 2);
     sprintf(filePath, "%s/%s", directoryName, fileName);
 
     return filePath;
 }
 
+/**
+ * Turn a path relative to the input directory into a single file name,
+ * so that files from nested input directories can be stored in the flat intermediate directories
+ * @param relativePath The path to flatten
+ * @param arena The arena to allocate the name from, or NULL to allocate it with malloc
+ * @return The flattened name
+ */
+char * flattenFilePath(char * relativePath, struct Arena * arena) {
+    char * flattened = arenaDuplicate(arena, relativePath);
+
+    for (char * c = flattened; *c; c++) {
+        if (*c == '/') {
+            *c = FLATTENED_PATH_SEPARATOR;
+        }
+    }
+
+    return flattened;
+}
+
+/**
+ * Turn a name created by flattenFilePath back into the original relative path, in place
+ * @param flattened The flattened name to restore
+ * @return The restored path
+ */
+char * restoreFilePath(char * flattened) {
+    for (char * c = flattened; *c; c++) {
+        if (*c == FLATTENED_PATH_SEPARATOR) {
+            *c = '/';
+        }
+    }
+
+    return flattened;
+}
+
 /**
  * Check if a given character is either a letter or a number
  * @param c The character to check
@@ -58,34 +149,34 @@ bool isLetterOrNumber (char c) {
 
 /**
  * Read and word from an open file stream
- * A word means a group of letters Aa-Zz or numbers 0-9
+ * A word means a group of letters Aa-Zz or numbers 0-9, words longer than MAX_WORD_LENGTH are truncated
  * @param file The file stream to read from
+ * @param arena The arena to allocate the word from, or NULL to allocate it with malloc
  * @return A pointer to the read word
  */
-char * readWord(FILE * file) {
-    char temp[255] = { '\0' };
+char * readWord(FILE * file, struct Arena * arena) {
+    char temp[MAX_WORD_LENGTH + 1] = { '\0' };
     int i = 0;
-    char c;
+    int c;
 
     while ((c = fgetc(file)) != EOF) {
         if (isLetterOrNumber(c)) {
-            temp[i++] = c;
-            temp[i] = '\0';
+            if (i < MAX_WORD_LENGTH) {
+                temp[i++] = c;
+                temp[i] = '\0';
+            }
         } else {
-            if (strlen(temp) == 0) { continue; }
+            if (i == 0) { continue; }
             else { break; }
         }
     }
 
     // EOF reached
-    if (strlen(temp) == 0) {
+    if (i == 0) {
         return NULL;
     }
 
-    char * word = (char *)malloc(strlen(temp));
-    strcpy(word, temp);
-
-    return word;
+    return arenaDuplicate(arena, temp);
 }
 
 /**
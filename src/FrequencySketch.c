@@ -0,0 +1,234 @@
+/**
+ * Function library for a Count-Min sketch that estimates the frequencies of words in a fixed amount of memory
+ *
+ * Every row hashes a word to one of its counters with a different seed. The width is fixed, so that the sketches of
+ * all the workers can be merged by adding their counters, and a counter also holds the frequencies of the other words
+ * that share it, about (total - counter) / (width - 1). Once there are more distinct words than counters in a row,
+ * that noise dominates the plain Count-Min estimate, so the estimate is Count-Mean-Min: the noise of every row
+ * is subtracted from its counter, and the median over the rows is taken, capped by the Count-Min estimate.
+ *
+ * A sketch file has the following layout:
+ *  {depth} {width} {total}     as binary integers
+ *  {counters}                  depth * width binary 32 bit counters
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "../defs/FrequencySketch.h"
+#include "../defs/WordCounter.h"
+#include "../defs/DirectoryStream.h"
+#include "../defs/FileOperations.h"
+#include "../defs/Logging.h"
+
+/**
+ * Initialize an empty sketch
+ * @param sketch The sketch to initialize
+ * @param depth The number of rows
+ * @param width The number of counters of a row, a power of two
+ */
+void initFrequencySketch(struct FrequencySketch * sketch, int depth, int width) {
+    sketch->depth = depth;
+    sketch->width = width;
+    sketch->total = 0;
+    sketch->counters = (uint32_t *)calloc((size_t)depth * width, sizeof(uint32_t));
+}
+
+/**
+ * Add an amount to the frequency of a word
+ * @param sketch The sketch to add to
+ * @param word The word
+ * @param amount The amount to add
+ */
+void addToFrequencySketch(struct FrequencySketch * sketch, const char * word, uint32_t amount) {
+    for (int row = 0; row < sketch->depth; row++) {
+        uint64_t column = hashWord(word, (uint64_t)row + 1) & (uint64_t)(sketch->width - 1);
+        uint32_t * counter = sketch->counters + (size_t)row * sketch->width + column;
+
+        // Saturate instead of wrapping around, an estimate must never be lower than the real frequency
+        *counter = *counter > UINT32_MAX - amount ? UINT32_MAX : *counter + amount;
+    }
+
+    sketch->total += amount;
+}
+
+/**
+ * Comparator used to sort the estimates of the rows
+ * @param a The first estimate
+ * @param b The second estimate
+ * @return The order of the two estimates
+ */
+static int compareEstimates(const void * a, const void * b) {
+    double first = *(const double *)a;
+    double second = *(const double *)b;
+
+    return (first > second) - (first < second);
+}
+
+/**
+ * Estimate the frequency of a word, with the noise of the other words that share its counters subtracted
+ * @param sketch The sketch to query
+ * @param word The word
+ * @return The estimated frequency, never higher than the Count-Min estimate and never negative
+ */
+long estimateFrequency(struct FrequencySketch * sketch, const char * word) {
+    if (sketch->depth <= 0 || sketch->depth > MAX_FREQUENCY_SKETCH_DEPTH) {
+        return 0;
+    }
+
+    double estimates[MAX_FREQUENCY_SKETCH_DEPTH];
+    uint32_t minimum = UINT32_MAX;
+
+    for (int row = 0; row < sketch->depth; row++) {
+        uint64_t column = hashWord(word, (uint64_t)row + 1) & (uint64_t)(sketch->width - 1);
+        uint32_t counter = sketch->counters[(size_t)row * sketch->width + column];
+
+        if (counter < minimum) {
+            minimum = counter;
+        }
+
+        // The other words of the row are spread evenly over its other counters
+        double noise = sketch->width > 1 ? (double)(sketch->total - counter) / (sketch->width - 1) : 0.0;
+        estimates[row] = counter - noise;
+    }
+
+    qsort(estimates, sketch->depth, sizeof(double), compareEstimates);
+    double median = sketch->depth % 2 == 1 ? estimates[sketch->depth / 2] :
+                    (estimates[sketch->depth / 2 - 1] + estimates[sketch->depth / 2]) / 2.0;
+
+    if (median > minimum) {
+        return (long)minimum;
+    }
+
+    return median > 0.0 ? (long)(median + 0.5) : 0;
+}
+
+/**
+ * Add the counters of a sketch to another one
+ * @param sketch The sketch to add to
+ * @param other The sketch to add, it must have the same size
+ * @return True or false, whether the sketches have the same size
+ */
+bool mergeFrequencySketch(struct FrequencySketch * sketch, struct FrequencySketch * other) {
+    if (sketch->depth != other->depth || sketch->width != other->width) {
+        return false;
+    }
+
+    size_t numberOfCounters = (size_t)sketch->depth * sketch->width;
+    for (size_t i = 0; i < numberOfCounters; i++) {
+        uint32_t counter = sketch->counters[i];
+        sketch->counters[i] = counter > UINT32_MAX - other->counters[i] ? UINT32_MAX : counter + other->counters[i];
+    }
+
+    sketch->total += other->total;
+    return true;
+}
+
+/**
+ * Write a sketch to a file
+ * @param sketch The sketch to write
+ * @param path The path of the file
+ * @return True or false, whether the sketch could be written
+ */
+bool writeFrequencySketch(struct FrequencySketch * sketch, char * path) {
+    FILE * file = createFile(path);
+    if (!file) {
+        return false;
+    }
+
+    size_t numberOfCounters = (size_t)sketch->depth * sketch->width;
+    bool written = fwrite(&sketch->depth, sizeof(int), 1, file) == 1 &&
+                   fwrite(&sketch->width, sizeof(int), 1, file) == 1 &&
+                   fwrite(&sketch->total, sizeof(long), 1, file) == 1 &&
+                   fwrite(sketch->counters, sizeof(uint32_t), numberOfCounters, file) == numberOfCounters;
+
+    return fclose(file) == 0 && written;
+}
+
+/**
+ * Read a sketch written by writeFrequencySketch
+ * @param sketch The sketch to initialize with the contents of the file
+ * @param path The path of the file
+ * @return True or false, whether the sketch could be read, the sketch is only initialized in case it could
+ */
+bool readFrequencySketch(struct FrequencySketch * sketch, char * path) {
+    FILE * file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+
+    int depth, width;
+    long total;
+    if (fread(&depth, sizeof(int), 1, file) != 1 ||
+        fread(&width, sizeof(int), 1, file) != 1 ||
+        fread(&total, sizeof(long), 1, file) != 1 ||
+        depth <= 0 || depth > MAX_FREQUENCY_SKETCH_DEPTH || width <= 0 || (width & (width - 1)) != 0) {
+        fclose(file);
+        return false;
+    }
+
+    initFrequencySketch(sketch, depth, width);
+    size_t numberOfCounters = (size_t)depth * width;
+    if (fread(sketch->counters, sizeof(uint32_t), numberOfCounters, file) != numberOfCounters) {
+        freeFrequencySketch(sketch);
+        fclose(file);
+        return false;
+    }
+    sketch->total = total;
+
+    fclose(file);
+    return true;
+}
+
+/**
+ * Merge all the sketches of a directory into a single one
+ * @param directoryName The directory of the sketches
+ * @param sketch The sketch in which all the others are merged, it is initialized with the default size
+ * @return True or false, whether the directory could be read
+ */
+bool loadFrequencySketches(char * directoryName, struct FrequencySketch * sketch) {
+    initFrequencySketch(sketch, FREQUENCY_SKETCH_DEPTH, FREQUENCY_SKETCH_WIDTH);
+
+    struct DirectoryStream * stream = openDirectoryStream(directoryName, false);
+    if (!stream) {
+        return false;
+    }
+
+    char * names[DIRECTORY_BATCH_SIZE];
+    int numberOfNames;
+
+    while ((numberOfNames = readDirectoryBatch(stream, names, DIRECTORY_BATCH_SIZE, NULL)) > 0) {
+        for (int i = 0; i < numberOfNames; i++) {
+            char * path = buildFilePath(directoryName, names[i], NULL);
+            struct FrequencySketch other;
+
+            if (!readFrequencySketch(&other, path)) {
+                printf("%sCould not read frequency sketch %s%s\n", KRED, path, KNRM);
+            } else {
+                if (!mergeFrequencySketch(sketch, &other)) {
+                    printf("%sFrequency sketch %s has a different size%s\n", KRED, path, KNRM);
+                }
+                freeFrequencySketch(&other);
+            }
+
+            free(path);
+            free(names[i]);
+        }
+    }
+
+    closeDirectoryStream(stream);
+    return true;
+}
+
+/**
+ * Free the counters of a sketch
+ * @param sketch The sketch to free
+ */
+void freeFrequencySketch(struct FrequencySketch * sketch) {
+    free(sketch->counters);
+    sketch->counters = NULL;
+    sketch->depth = sketch->width = 0;
+    sketch->total = 0;
+}
@@ -0,0 +1,416 @@
+/**
+ * Function library for the lexicon of the reverse index
+ *
+ * The minimal perfect hash is built with the hash and displace method: the words are spread over buckets of
+ * about LEXICON_TERMS_PER_BUCKET words, and starting with the largest bucket, every bucket gets the first pilot value
+ * that sends all its words to free slots. Buckets with a single word are placed last, straight into the remaining
+ * free slots, by storing the slot itself as a negative pilot.
+ *
+ * The Bloom filter is blocked: all the bits of a word are set in a single cache line of BLOOM_BLOCK_BITS bits,
+ * so rejecting an absent word costs one cache miss instead of one per hash function.
+ *
+ * File layout: header, Bloom filter blocks aligned to a cache line, pilots, slots, word strings
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../defs/Lexicon.h"
+#include "../defs/WordCounter.h"
+#include "../defs/Logging.h"
+
+#define LEXICON_TERMS_PER_BUCKET 4
+#define LEXICON_MAX_PILOT (1 << 24)
+#define LEXICON_BUILD_ATTEMPTS 8
+#define BLOOM_BITS_PER_TERM 10
+#define BLOOM_HASHES 7
+#define BLOOM_BLOCK_BITS 512
+#define BLOOM_BLOCK_WORDS (BLOOM_BLOCK_BITS / 64)
+// The number of bits of the hash that select a bit within a block, 7 hashes take 63 bits
+#define BLOOM_BIT_INDEX_BITS 9
+
+/**
+ * Mix the bits of a 64 bit value, the finalizer of splitmix64
+ * @param value The value to mix
+ * @return The mixed value
+ */
+static uint64_t mixHash(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ULL;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBULL;
+    value ^= value >> 31;
+
+    return value;
+}
+
+/**
+ * Get the bucket of a word from its hash
+ * @param hash The hash of the word
+ * @param numberOfBuckets The number of buckets
+ * @return The bucket of the word
+ */
+static uint64_t getBucket(uint64_t hash, uint64_t numberOfBuckets) {
+    return mixHash(hash) % numberOfBuckets;
+}
+
+/**
+ * Get the slot of a word from its hash and the pilot of its bucket
+ * @param hash The hash of the word
+ * @param pilot The pilot of the bucket of the word
+ * @param numberOfTerms The number of words, which is also the number of slots
+ * @return The slot of the word
+ */
+static uint64_t getSlot(uint64_t hash, int32_t pilot, uint64_t numberOfTerms) {
+    if (pilot < 0) {
+        return (uint64_t)(-(int64_t)pilot - 1);
+    }
+
+    return mixHash(mixHash(hash ^ 0x2545F4914F6CDD1DULL) ^ ((uint64_t)pilot * 0x9E3779B97F4A7C15ULL)) % numberOfTerms;
+}
+
+/**
+ * Get the Bloom filter block of a word, the cache line that holds all of its bits
+ * @param hash The hash of the word
+ * @param numberOfBlocks The number of blocks of the Bloom filter
+ * @return The index of the block
+ */
+static uint64_t getBloomBlock(uint64_t hash, uint64_t numberOfBlocks) {
+    return mixHash(hash ^ 0xD6E8FEB86659FD93ULL) % numberOfBlocks;
+}
+
+/**
+ * Get the bits of a word within its Bloom filter block
+ * @param hash The hash of the word
+ * @return A hash whose i-th group of BLOOM_BIT_INDEX_BITS bits is the index of the i-th bit of the word in its block
+ */
+static uint64_t getBloomBits(uint64_t hash) {
+    return mixHash(hash ^ 0xA0761D6478BD642FULL);
+}
+
+// The bucket sizes used by compareBucketSizes, since qsort does not take a context
+static const uint32_t * bucketSizes;
+
+/**
+ * Comparator that orders bucket indexes by decreasing bucket size
+ * @param a The first bucket index
+ * @param b The second bucket index
+ * @return The order of the two buckets
+ */
+static int compareBucketSizes(const void * a, const void * b) {
+    uint32_t first = bucketSizes[*(const uint32_t *)a];
+    uint32_t second = bucketSizes[*(const uint32_t *)b];
+
+    return (first < second) - (first > second);
+}
+
+/**
+ * Find the pilot of every bucket for the given seed
+ * @param hashes The hashes of the words
+ * @param numberOfTerms The number of words
+ * @param numberOfBuckets The number of buckets
+ * @param pilots Where the pilots are stored
+ * @return True or false, whether a pilot was found for every bucket
+ */
+static bool findPilots(uint64_t * hashes, uint64_t numberOfTerms, uint64_t numberOfBuckets, int32_t * pilots) {
+    uint32_t * sizes = (uint32_t *)calloc(numberOfBuckets, sizeof(uint32_t));
+    uint64_t * bucketStarts = (uint64_t *)calloc(numberOfBuckets + 1, sizeof(uint64_t));
+    uint64_t * bucketTerms = (uint64_t *)malloc(numberOfTerms * sizeof(uint64_t));
+    uint32_t * order = (uint32_t *)malloc(numberOfBuckets * sizeof(uint32_t));
+    unsigned char * taken = (unsigned char *)calloc(numberOfTerms, 1);
+    bool found = true;
+
+    // Group the words by bucket, with a counting sort
+    for (uint64_t i = 0; i < numberOfTerms; i++) {
+        sizes[getBucket(hashes[i], numberOfBuckets)]++;
+    }
+    for (uint64_t b = 0; b < numberOfBuckets; b++) {
+        bucketStarts[b + 1] = bucketStarts[b] + sizes[b];
+        order[b] = (uint32_t)b;
+    }
+    for (uint64_t i = 0; i < numberOfTerms; i++) {
+        uint64_t bucket = getBucket(hashes[i], numberOfBuckets);
+        bucketTerms[bucketStarts[bucket + 1] - sizes[bucket]--] = i;
+    }
+    for (uint64_t b = 0; b < numberOfBuckets; b++) {
+        sizes[b] = (uint32_t)(bucketStarts[b + 1] - bucketStarts[b]);
+    }
+
+    bucketSizes = sizes;
+    qsort(order, numberOfBuckets, sizeof(uint32_t), compareBucketSizes);
+
+    uint64_t nextFreeSlot = 0;
+    uint64_t slots[64];
+
+    for (uint64_t o = 0; o < numberOfBuckets && found; o++) {
+        uint32_t bucket = order[o];
+        uint32_t size = sizes[bucket];
+        uint64_t * terms = bucketTerms + bucketStarts[bucket];
+
+        if (size == 0) {
+            pilots[bucket] = 0;
+            continue;
+        }
+
+        if (size == 1) {
+            while (taken[nextFreeSlot]) {
+                nextFreeSlot++;
+            }
+
+            taken[nextFreeSlot] = 1;
+            pilots[bucket] = -(int32_t)nextFreeSlot - 1;
+            continue;
+        }
+
+        if (size > 64) {
+            found = false;
+            break;
+        }
+
+        int32_t pilot;
+        for (pilot = 0; pilot < LEXICON_MAX_PILOT; pilot++) {
+            bool fits = true;
+
+            for (uint32_t t = 0; t < size && fits; t++) {
+                slots[t] = getSlot(hashes[terms[t]], pilot, numberOfTerms);
+                fits = !taken[slots[t]];
+
+                for (uint32_t u = 0; u < t && fits; u++) {
+                    fits = slots[u] != slots[t];
+                }
+            }
+
+            if (fits) {
+                break;
+            }
+        }
+
+        if (pilot == LEXICON_MAX_PILOT) {
+            found = false;
+            break;
+        }
+
+        for (uint32_t t = 0; t < size; t++) {
+            taken[slots[t]] = 1;
+        }
+        pilots[bucket] = pilot;
+    }
+
+    free(sizes);
+    free(bucketStarts);
+    free(bucketTerms);
+    free(order);
+    free(taken);
+
+    return found;
+}
+
+/**
+ * Build a lexicon file for the given words
+ * @param path The path of the lexicon file to write
+ * @param terms The words, without duplicates
+ * @param locations The posting location of every word
+ * @param numberOfTerms The number of words
+ * @return True or false, whether the lexicon could be built and written
+ */
+bool buildLexicon(char * path, char ** terms, struct PostingLocation * locations, uint64_t numberOfTerms) {
+    if (numberOfTerms > INT32_MAX) {
+        printf("%sToo many words for a lexicon: %lu%s\n", KRED, (unsigned long)numberOfTerms, KNRM);
+        return false;
+    }
+
+    struct LexiconHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LEXICON_MAGIC, sizeof(header.magic));
+    header.numberOfTerms = numberOfTerms;
+    header.numberOfBuckets = numberOfTerms / LEXICON_TERMS_PER_BUCKET + 1;
+    header.bloomBits = (numberOfTerms * BLOOM_BITS_PER_TERM / BLOOM_BLOCK_BITS + 1) * BLOOM_BLOCK_BITS;
+    header.bloomHashes = BLOOM_HASHES;
+
+    uint64_t * hashes = (uint64_t *)malloc((numberOfTerms + 1) * sizeof(uint64_t));
+    int32_t * pilots = (int32_t *)malloc(header.numberOfBuckets * sizeof(int32_t));
+    bool found = false;
+
+    // A different seed is tried when two words cannot be separated, which only happens on a full hash collision
+    for (int attempt = 0; attempt < LEXICON_BUILD_ATTEMPTS && !found; attempt++) {
+        header.seed = (uint64_t)attempt;
+
+        for (uint64_t i = 0; i < numberOfTerms; i++) {
+            hashes[i] = hashWord(terms[i], header.seed);
+        }
+
+        found = findPilots(hashes, numberOfTerms, header.numberOfBuckets, pilots);
+    }
+
+    if (!found) {
+        printf("%sCould not build the perfect hash of the lexicon, are there duplicate words?%s\n", KRED, KNRM);
+        free(hashes);
+        free(pilots);
+        return false;
+    }
+
+    uint64_t bloomWords = header.bloomBits / 64;
+    uint64_t numberOfBlocks = header.bloomBits / BLOOM_BLOCK_BITS;
+    uint64_t * bloom = (uint64_t *)calloc(bloomWords, sizeof(uint64_t));
+    struct LexiconSlot * slots = (struct LexiconSlot *)calloc(numberOfTerms + 1, sizeof(struct LexiconSlot));
+    uint64_t stringsLength = 0;
+
+    for (uint64_t i = 0; i < numberOfTerms; i++) {
+        uint64_t bucket = getBucket(hashes[i], header.numberOfBuckets);
+        struct LexiconSlot * slot = slots + getSlot(hashes[i], pilots[bucket], numberOfTerms);
+
+        slot->termOffset = stringsLength;
+        slot->location = locations[i];
+        stringsLength += strlen(terms[i]) + 1;
+
+        uint64_t * block = bloom + getBloomBlock(hashes[i], numberOfBlocks) * BLOOM_BLOCK_WORDS;
+        uint64_t bits = getBloomBits(hashes[i]);
+        for (uint64_t h = 0; h < header.bloomHashes; h++) {
+            uint64_t bit = (bits >> (h * BLOOM_BIT_INDEX_BITS)) & (BLOOM_BLOCK_BITS - 1);
+            block[bit / 64] |= 1ULL << (bit % 64);
+        }
+    }
+
+    // The sections are 8 byte aligned, so that they can be used in place once the file is mapped,
+    // and the Bloom filter starts on a cache line, so that every block is a single one
+    uint64_t pilotsSize = (header.numberOfBuckets * sizeof(int32_t) + 7) & ~7ULL;
+    header.bloomOffset = (sizeof(header) + BLOOM_BLOCK_BITS / 8 - 1) & ~(uint64_t)(BLOOM_BLOCK_BITS / 8 - 1);
+    header.pilotsOffset = header.bloomOffset + bloomWords * sizeof(uint64_t);
+    header.slotsOffset = header.pilotsOffset + pilotsSize;
+    header.stringsOffset = header.slotsOffset + numberOfTerms * sizeof(struct LexiconSlot);
+    header.stringsLength = stringsLength;
+
+    FILE * file = fopen(path, "wb");
+    bool written = file != NULL;
+
+    if (written) {
+        char padding[BLOOM_BLOCK_BITS / 8] = { 0 };
+
+        written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(padding, 1, header.bloomOffset - sizeof(header), file) == header.bloomOffset - sizeof(header) &&
+                  fwrite(bloom, sizeof(uint64_t), bloomWords, file) == bloomWords &&
+                  fwrite(pilots, sizeof(int32_t), header.numberOfBuckets, file) == header.numberOfBuckets &&
+                  fwrite(&padding, 1, pilotsSize - header.numberOfBuckets * sizeof(int32_t), file) ==
+                      pilotsSize - header.numberOfBuckets * sizeof(int32_t) &&
+                  fwrite(slots, sizeof(struct LexiconSlot), numberOfTerms, file) == numberOfTerms;
+
+        for (uint64_t i = 0; i < numberOfTerms && written; i++) {
+            written = fwrite(terms[i], 1, strlen(terms[i]) + 1, file) == strlen(terms[i]) + 1;
+        }
+
+        written = fclose(file) == 0 && written;
+    }
+
+    if (!written) {
+        printf("%sCould not write lexicon %s%s\n", KRED, path, KNRM);
+    }
+
+    free(hashes);
+    free(pilots);
+    free(bloom);
+    free(slots);
+
+    return written;
+}
+
+/**
+ * Open and map a lexicon file
+ * @param path The path of the lexicon file
+ * @return The opened lexicon or NULL in case the file could not be read or is not a lexicon
+ */
+struct Lexicon * openLexicon(char * path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return NULL;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == -1 || (size_t)fileStat.st_size < sizeof(struct LexiconHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    void * map = mmap(NULL, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    const struct LexiconHeader * header = (const struct LexiconHeader *)map;
+    if (memcmp(header->magic, LEXICON_MAGIC, sizeof(header->magic)) != 0 ||
+        header->bloomBits % BLOOM_BLOCK_BITS != 0 || header->bloomBits == 0 ||
+        header->bloomHashes * BLOOM_BIT_INDEX_BITS > 64 ||
+        header->stringsOffset + header->stringsLength > (uint64_t)fileStat.st_size) {
+        printf("%s%s is not a valid lexicon%s\n", KRED, path, KNRM);
+        munmap(map, fileStat.st_size);
+        return NULL;
+    }
+
+    struct Lexicon * lexicon = (struct Lexicon *)malloc(sizeof(struct Lexicon));
+    lexicon->map = map;
+    lexicon->size = fileStat.st_size;
+    lexicon->header = header;
+    lexicon->bloom = (const uint64_t *)((const char *)map + header->bloomOffset);
+    lexicon->pilots = (const int32_t *)((const char *)map + header->pilotsOffset);
+    lexicon->slots = (const struct LexiconSlot *)((const char *)map + header->slotsOffset);
+    lexicon->strings = (const char *)map + header->stringsOffset;
+
+    return lexicon;
+}
+
+/**
+ * Look up the posting location of a word
+ * @param lexicon The lexicon to look into
+ * @param term The word to look for
+ * @param location Where the posting location is stored when the word is found
+ * @return True or false, whether the word is in the lexicon
+ */
+bool lookupTerm(struct Lexicon * lexicon, const char * term, struct PostingLocation * location) {
+    const struct LexiconHeader * header = lexicon->header;
+    if (header->numberOfTerms == 0) {
+        return false;
+    }
+
+    uint64_t hash = hashWord(term, header->seed);
+
+    // All the bits of the word are in the same cache line
+    const uint64_t * block = lexicon->bloom + getBloomBlock(hash, header->bloomBits / BLOOM_BLOCK_BITS) * BLOOM_BLOCK_WORDS;
+    uint64_t bits = getBloomBits(hash);
+    for (uint64_t h = 0; h < header->bloomHashes; h++) {
+        uint64_t bit = (bits >> (h * BLOOM_BIT_INDEX_BITS)) & (BLOOM_BLOCK_BITS - 1);
+        if (!(block[bit / 64] & (1ULL << (bit % 64)))) {
+            return false;
+        }
+    }
+
+    int32_t pilot = lexicon->pilots[getBucket(hash, header->numberOfBuckets)];
+    const struct LexiconSlot * slot = lexicon->slots + getSlot(hash, pilot, header->numberOfTerms);
+
+    // Words that passed the Bloom filter by chance land on the slot of another word
+    if (strcmp(lexicon->strings + slot->termOffset, term) != 0) {
+        return false;
+    }
+
+    *location = slot->location;
+    return true;
+}
+
+/**
+ * Unmap and free a lexicon
+ * @param lexicon The lexicon to close
+ */
+void closeLexicon(struct Lexicon * lexicon) {
+    if (!lexicon) {
+        return;
+    }
+
+    munmap(lexicon->map, lexicon->size);
+    free(lexicon);
+}
@@ -0,0 +1,224 @@
+/**
+ * Function library for the posting segments that the reduce stage writes for the lexicon
+ *
+ * Every worker appends the postings of every word it reduces to {rank}.postings, as they are written to the reverse
+ * index file of the word, and a "{word} {offset} {length}" line to {rank}.terms.
+ * The master then builds the lexicon from all the word lists, so a lookup reads the postings of a word
+ * from the segment of its rank, which a reader keeps open, instead of opening a file per word.
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "../defs/LexiconSegments.h"
+#include "../defs/DirectoryStream.h"
+#include "../defs/FileOperations.h"
+#include "../defs/Logging.h"
+
+#define POSTINGS_EXTENSION ".postings"
+#define TERMS_EXTENSION ".terms"
+
+/**
+ * Open the segment files of a worker for appending
+ * @param segmentsDirectory The directory of the segments
+ * @param rank The rank of the worker, which is also the segment number
+ * @param segment Where the opened files are stored
+ * @return True or false, whether both files could be opened
+ */
+bool openLexiconSegment(char * segmentsDirectory, int rank, struct LexiconSegment * segment) {
+    char name[64];
+
+    snprintf(name, sizeof(name), "%d%s", rank, POSTINGS_EXTENSION);
+    char * postingsPath = buildFilePath(segmentsDirectory, name, NULL);
+    segment->postings = fopen(postingsPath, "ab");
+
+    snprintf(name, sizeof(name), "%d%s", rank, TERMS_EXTENSION);
+    char * termsPath = buildFilePath(segmentsDirectory, name, NULL);
+    segment->terms = fopen(termsPath, "a");
+
+    free(postingsPath);
+    free(termsPath);
+
+    if (!segment->postings || !segment->terms) {
+        printf("%sCould not open lexicon segment %d%s\n", KRED, rank, KNRM);
+        closeLexiconSegment(segment);
+        return false;
+    }
+
+    // The offsets continue after the postings of an earlier run with the same rank
+    fseek(segment->postings, 0, SEEK_END);
+    segment->postingsLength = (uint64_t)ftell(segment->postings);
+
+    return true;
+}
+
+/**
+ * Append the postings of a word to a segment and record their location
+ * Both files are flushed, so the master can read them as soon as the task is reported
+ * @param segment The segment to append to
+ * @param term The word
+ * @param postings The postings of the word, as written to its reverse index file
+ * @param length The length of the postings
+ * @return True or false, whether the postings were appended
+ */
+bool appendToLexiconSegment(struct LexiconSegment * segment, char * term, char * postings, size_t length) {
+    if (length > UINT32_MAX || fwrite(postings, 1, length, segment->postings) != length) {
+        return false;
+    }
+
+    fprintf(segment->terms, "%s %llu %zu\n", term, (unsigned long long)segment->postingsLength, length);
+    segment->postingsLength += length;
+
+    return fflush(segment->postings) == 0 && fflush(segment->terms) == 0;
+}
+
+/**
+ * Close the files of a segment
+ * @param segment The segment to close
+ */
+void closeLexiconSegment(struct LexiconSegment * segment) {
+    if (segment->postings) { fclose(segment->postings); }
+    if (segment->terms) { fclose(segment->terms); }
+
+    segment->postings = segment->terms = NULL;
+}
+
+/**
+ * Build the lexicon from the word lists of all the segments
+ * @param segmentsDirectory The directory of the segments
+ * @param lexiconPath The path of the lexicon file to write
+ * @return True or false, whether the lexicon was built
+ */
+bool buildLexiconFromSegments(char * segmentsDirectory, char * lexiconPath) {
+    struct DirectoryStream * stream = openDirectoryStream(segmentsDirectory, false);
+    if (!stream) {
+        return false;
+    }
+
+    char ** terms = NULL;
+    struct PostingLocation * locations = NULL;
+    uint64_t numberOfTerms = 0;
+    uint64_t capacity = 0;
+
+    char * names[DIRECTORY_BATCH_SIZE];
+    int numberOfNames;
+
+    while ((numberOfNames = readDirectoryBatch(stream, names, DIRECTORY_BATCH_SIZE, NULL)) > 0) {
+        for (int i = 0; i < numberOfNames; i++) {
+            size_t nameLength = strlen(names[i]);
+            size_t extensionLength = strlen(TERMS_EXTENSION);
+
+            if (nameLength > extensionLength && strcmp(names[i] + nameLength - extensionLength, TERMS_EXTENSION) == 0) {
+                char * termsPath = buildFilePath(segmentsDirectory, names[i], NULL);
+                FILE * termsFile = fopen(termsPath, "r");
+                free(termsPath);
+
+                char term[256];
+                unsigned long offset, length;
+                uint32_t segmentNumber = (uint32_t)strtoul(names[i], NULL, 10);
+
+                while (termsFile && fscanf(termsFile, "%255s %lu %lu", term, &offset, &length) == 3) {
+                    if (numberOfTerms == capacity) {
+                        capacity = capacity ? capacity * 2 : 1024;
+                        terms = (char **)realloc(terms, capacity * sizeof(char *));
+                        locations = (struct PostingLocation *)realloc(locations, capacity * sizeof(struct PostingLocation));
+                    }
+
+                    terms[numberOfTerms] = strdup(term);
+                    locations[numberOfTerms].segment = segmentNumber;
+                    locations[numberOfTerms].offset = offset;
+                    locations[numberOfTerms].length = (uint32_t)length;
+                    numberOfTerms++;
+                }
+
+                if (termsFile) { fclose(termsFile); }
+            }
+
+            free(names[i]);
+        }
+    }
+    closeDirectoryStream(stream);
+
+    bool built = buildLexicon(lexiconPath, terms, locations, numberOfTerms);
+
+    for (uint64_t i = 0; i < numberOfTerms; i++) {
+        free(terms[i]);
+    }
+    free(terms);
+    free(locations);
+
+    return built;
+}
+
+/**
+ * Start reading postings from the segments of a directory, the segments are opened on their first read
+ * @param reader The reader to initialize
+ * @param segmentsDirectory The directory of the segments
+ */
+void openSegmentReader(struct SegmentReader * reader, char * segmentsDirectory) {
+    reader->segmentsDirectory = segmentsDirectory;
+    reader->descriptors = NULL;
+    reader->numberOfDescriptors = 0;
+}
+
+/**
+ * Read the postings of a word from the segment that holds them, with a single pread once the segment is open
+ * @param reader The reader of the segments
+ * @param location The location of the postings, as returned by lookupTerm
+ * @return The NUL terminated postings, which must be freed by the caller, or NULL in case they could not be read
+ */
+char * readPostings(struct SegmentReader * reader, struct PostingLocation * location) {
+    if (location->segment >= reader->numberOfDescriptors) {
+        uint32_t numberOfDescriptors = location->segment + 1;
+        reader->descriptors = (int *)realloc(reader->descriptors, numberOfDescriptors * sizeof(int));
+        for (uint32_t i = reader->numberOfDescriptors; i < numberOfDescriptors; i++) {
+            reader->descriptors[i] = -1;
+        }
+        reader->numberOfDescriptors = numberOfDescriptors;
+    }
+
+    int descriptor = reader->descriptors[location->segment];
+    if (descriptor == -1) {
+        char name[64];
+        snprintf(name, sizeof(name), "%u%s", location->segment, POSTINGS_EXTENSION);
+
+        char * postingsPath = buildFilePath(reader->segmentsDirectory, name, NULL);
+        descriptor = reader->descriptors[location->segment] = open(postingsPath, O_RDONLY);
+        free(postingsPath);
+
+        if (descriptor == -1) {
+            return NULL;
+        }
+    }
+
+    char * buffer = (char *)malloc(location->length + 1);
+    ssize_t bytesRead = pread(descriptor, buffer, location->length, (off_t)location->offset);
+
+    if (bytesRead != (ssize_t)location->length) {
+        free(buffer);
+        return NULL;
+    }
+
+    buffer[location->length] = '\0';
+    return buffer;
+}
+
+/**
+ * Close the segments opened by a reader
+ * @param reader The reader to close
+ */
+void closeSegmentReader(struct SegmentReader * reader) {
+    for (uint32_t i = 0; i < reader->numberOfDescriptors; i++) {
+        if (reader->descriptors[i] != -1) {
+            close(reader->descriptors[i]);
+        }
+    }
+
+    free(reader->descriptors);
+    reader->descriptors = NULL;
+    reader->numberOfDescriptors = 0;
+}
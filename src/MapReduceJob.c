@@ -0,0 +1,151 @@
+/**
+ * Function library for the pluggable jobs that are fed from the tokenization pass of the map stage
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include "../defs/MapReduceJob.h"
+#include "../defs/DirectoryStream.h"
+#include "../defs/FileOperations.h"
+#include "../defs/Utils.h"
+#include "../defs/Logging.h"
+
+static struct MapReduceJob * registeredJobs[MAX_MAP_REDUCE_JOBS];
+static int numberOfRegisteredJobs = 0;
+
+/**
+ * Register a job, so that it is fed from the map stage and reduced in the final stage
+ * Every process has to register the same jobs in the same order
+ * @param job The job to register, it has to outlive the run
+ * @return True or false, whether the job could be registered
+ */
+bool registerMapReduceJob(struct MapReduceJob * job) {
+    if (numberOfRegisteredJobs == MAX_MAP_REDUCE_JOBS || findMapReduceJob(job->name)) {
+        printf("%sCould not register job %s%s\n", KRED, job->name, KNRM);
+        return false;
+    }
+
+    registeredJobs[numberOfRegisteredJobs++] = job;
+    return true;
+}
+
+/**
+ * Get the number of registered jobs
+ * @return The number of registered jobs
+ */
+int getNumberOfMapReduceJobs(void) {
+    return numberOfRegisteredJobs;
+}
+
+/**
+ * Get a registered job by its registration index
+ * @param index The index of the job
+ * @return The job
+ */
+struct MapReduceJob * getMapReduceJob(int index) {
+    return registeredJobs[index];
+}
+
+/**
+ * Find a registered job by its name
+ * @param name The name of the job
+ * @return The job or NULL in case no job with the given name was registered
+ */
+struct MapReduceJob * findMapReduceJob(char * name) {
+    for (int i = 0; i < numberOfRegisteredJobs; i++) {
+        if (strcmp(registeredJobs[i]->name, name) == 0) {
+            return registeredJobs[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Emit function that writes a pair to the channel of a job
+ * A pair is stored as {channel}/{key}/{fileName}_{value}_{timestamp}, the same way the reverse index stores its postings
+ * @param emitContext The JobChannel to write to
+ * @param key The key of the pair
+ * @param value The value of the pair
+ */
+void emitToJobChannel(void * emitContext, char * key, long value) {
+    struct JobChannel * channel = (struct JobChannel *)emitContext;
+
+    if (key[0] == '\0' || strlen(key) > NAME_MAX || strchr(key, '/') || strcmp(key, ".") == 0 || strcmp(key, "..") == 0) {
+        printf("%sIgnoring invalid key \"%s\" emitted for file %s%s\n", KRED, key, channel->fileName, KNRM);
+        return;
+    }
+
+    char * keyPath = buildFilePath(channel->directory, key, NULL);
+    mkdir(keyPath, 0777);
+
+    char pairName[FILENAME_MAX];
+    snprintf(pairName, FILENAME_MAX, "%s_%ld_%ld", channel->fileName, value, getCurrentTimestamp());
+    char * pairPath = buildFilePath(keyPath, pairName, NULL);
+
+    FILE * pairFile = createFile(pairPath);
+    if (pairFile) {
+        fclose(pairFile);
+    }
+
+    free(pairPath);
+    free(keyPath);
+}
+
+/**
+ * Fold all the values emitted for a key and write the result to {outputDirectory}/{key}
+ * @param job The job the key belongs to
+ * @param channelDirectory The channel directory of the job
+ * @param key The key to reduce
+ * @param outputDirectory The output directory of the job
+ * @return True or false, whether the result could be written
+ */
+bool reduceJobKey(struct MapReduceJob * job, char * channelDirectory, char * key, char * outputDirectory) {
+    char * keyPath = buildFilePath(channelDirectory, key, NULL);
+    struct DirectoryStream * pairs = openDirectoryStream(keyPath, false);
+    free(keyPath);
+
+    if (!pairs) {
+        return false;
+    }
+
+    long accumulated = 0;
+    char * names[DIRECTORY_BATCH_SIZE];
+    int numberOfNames;
+
+    while ((numberOfNames = readDirectoryBatch(pairs, names, DIRECTORY_BATCH_SIZE, NULL)) > 0) {
+        for (int i = 0; i < numberOfNames; i++) {
+            // The file name may contain '_', so the value is the second field from the end
+            char * timestamp = strrchr(names[i], '_');
+            if (timestamp) {
+                *timestamp = '\0';
+                char * value = strrchr(names[i], '_');
+                if (value) {
+                    accumulated = job->reduce(accumulated, strtol(value + 1, NULL, 10));
+                }
+            }
+
+            free(names[i]);
+        }
+    }
+    closeDirectoryStream(pairs);
+
+    char * outputPath = buildFilePath(outputDirectory, key, NULL);
+    FILE * output = createFile(outputPath);
+    free(outputPath);
+
+    if (!output) {
+        return false;
+    }
+
+    fprintf(output, "%ld\n", accumulated);
+    fclose(output);
+
+    return true;
+}
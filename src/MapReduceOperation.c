@@ -48,6 +48,34 @@ struct Operation * getNextOperation(struct Operation * operations, int numberOfO
     return NULL;
 }
 
+/**
+ * Get the next doable operation for a given worker, the direct index of a file is only given to
+ * a worker on the node that mapped it, where its output is readable from shared memory
+ * @param operations The collection of operations
+ * @param numberOfOperations The total number of operations that each MapReduce phase has to do
+ * @param worker The worker the operation is for
+ * @param nodeOfRank The node of every rank, NULL when any worker can take any operation
+ * @return The next operation to assign to the worker, NULL if none of the doable ones fits it
+ */
+struct Operation * getNextOperationForWorker(struct Operation * operations, int numberOfOperations, int worker,
+                                             int * nodeOfRank) {
+    for (int i = 0; i < numberOfOperations; i++) {
+        struct Operation * op = operations + i;
+        if (op->currentOperation != Available || op->lastOperation == Done) {
+            continue;
+        }
+
+        if (nodeOfRank != NULL && op->lastOperation == GetWords && op->mapRank > 0 &&
+            nodeOfRank[op->mapRank] != nodeOfRank[worker]) {
+            continue;
+        }
+
+        return op;
+    }
+
+    return NULL;
+}
+
 /**
  * Change the current status of the operation with the given name
  * @param operations The collections of operations
@@ -94,6 +122,29 @@ void changeOperationLastStatusByName(struct Operation *operations, int numberOfO
     printf("%sNo operation with name %s could be found%s\n", KRED, operationName, KNRM);
 }
 
+/**
+ * Record the worker that mapped the file of the operation with the given name
+ * @param operations The collections of operations
+ * @param numberOfOperations The maximum number of operations that each MapReduce phase has to do
+ * @param operationName The name of the operation
+ * @param mapRank The worker whose shared segment holds the words of the file, or 0 when they are in files
+ */
+void changeOperationMapRankByName(struct Operation *operations, int numberOfOperations, char *operationName,
+                                  int mapRank) {
+    struct Operation * operation;
+
+    for (int i = 0; i < numberOfOperations; i++) {
+        operation = operations + i;
+
+        if (strcasecmp(operation->filename, operationName) == 0) {
+            operation->mapRank = mapRank;
+            return;
+        }
+    }
+
+    printf("%sNo operation with name %s could be found%s\n", KRED, operationName, KNRM);
+}
+
 /**
  * Return the next task code to send to a worker
  * @param lastTag The last operation tag
@@ -117,11 +168,39 @@ int getNextTaskForTag(enum OperationTag lastTag) {
  * @return The process id of the next available worker
  */
 int getAvailableWorkerId(bool workers[], int numberOfWorkers) {
-    for (int i = 1; i < numberOfWorkers - 1; i++) {
+    for (int i = 1; i < numberOfWorkers; i++) {
         if (workers[i] == true) {
             return i;
         }
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+/**
+ * Get a readable name for a task code, used in the logs and the exported metrics
+ * @param tag The task code
+ * @return The name of the task
+ */
+char * getTaskName(int tag) {
+    switch (tag) {
+        case TASK_PROCESS_WORDS:
+            return "process_words";
+        case TASK_INDEX_FILE:
+            return "index_file";
+        case TASK_REVERSE_INDEX_FILE:
+            return "reverse_index_file";
+        case TASK_REVERSE_INDEX_WORD:
+            return "reverse_index_word";
+        case TASK_REVERSE_INDEX_PART:
+            return "reverse_index_part";
+        case TASK_REVERSE_INDEX_MERGE:
+            return "reverse_index_merge";
+        case TASK_JOB_REDUCE:
+            return "job_reduce";
+        case TASK_FLUSH_SKETCH:
+            return "flush_sketch";
+        default:
+            return "unknown";
+    }
+}
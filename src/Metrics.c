@@ -0,0 +1,569 @@
+/**
+ * Function library for the live metrics of the master, exported in the Prometheus text format
+ *
+ * The workers append the number of bytes they read and wrote during a task to its completion message,
+ * after the terminating character of the task name, as "{bytesRead} {bytesWritten}", followed by the number of
+ * allocations and the peak size of the arena of the task, " {arenaAllocations} {arenaPeakBytes}".
+ * The report of a map task can end with a marker after them, see appendSharedOutputMarker.
+ * The master counts the dispatched and completed tasks, and exports the metrics either to a textfile that is
+ * atomically replaced every METRICS_EXPORT_INTERVAL, for the textfile collector of the node exporter,
+ * or to every client of a Unix-domain socket, as a plain HTTP response.
+ * Both are checked from the scheduler loop without blocking, and at most every METRICS_POLL_INTERVAL.
+ * Every completed task can also be appended to a trace, see TaskTrace.c, for the scheduler simulator.
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../defs/Metrics.h"
+#include "../defs/TaskTrace.h"
+#include "../defs/Utils.h"
+#include "../defs/Logging.h"
+
+// The tasks that are counted, in the order of their counters
+static const int metricsTasks[NUMBER_OF_METRICS_TASKS] = {
+    TASK_PROCESS_WORDS,
+    TASK_INDEX_FILE,
+    TASK_REVERSE_INDEX_FILE,
+    TASK_REVERSE_INDEX_WORD,
+    TASK_REVERSE_INDEX_PART,
+    TASK_REVERSE_INDEX_MERGE,
+    TASK_JOB_REDUCE
+};
+
+// The names of the states of the per-file stages
+static const char * metricsStates[NUMBER_OF_METRICS_STATES] = { "pending", "running" };
+
+/**
+ * Get the counter of a task
+ * @param tag The task code
+ * @return The index of its counters, or -1 for the tasks that are not counted
+ */
+static int getMetricsTaskIndex(int tag) {
+    for (int i = 0; i < NUMBER_OF_METRICS_TASKS; i++) {
+        if (metricsTasks[i] == tag) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Read the number of bytes the current process moved through read and write system calls, from /proc/self/io
+ * @param counters Where the counters are stored, they are 0 in case they could not be read
+ * @return True or false, whether the counters could be read
+ */
+bool readIoCounters(struct IoCounters * counters) {
+    counters->bytesRead = counters->bytesWritten = 0;
+
+    FILE * file = fopen("/proc/self/io", "r");
+    if (!file) {
+        return false;
+    }
+
+    char name[32];
+    long value;
+    while (fscanf(file, "%31s %ld", name, &value) == 2) {
+        if (strcmp(name, "rchar:") == 0) {
+            counters->bytesRead = value;
+        } else if (strcmp(name, "wchar:") == 0) {
+            counters->bytesWritten = value;
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+/**
+ * Build the completion message of a task, the task name followed by the bytes moved since the task started
+ * and the use of the arena of the task
+ * @param buffer Where the message is built
+ * @param size The size of the buffer
+ * @param taskName The name of the task, or NULL for tasks reported without a name
+ * @param taskStart The counters read when the task started, or NULL to send the name alone
+ * @param taskArena The arena of the task, before it is reset, or NULL to leave its use out
+ * @return The length of the message, including the terminating character of the task name
+ */
+int formatTaskReport(char * buffer, int size, char * taskName, struct IoCounters * taskStart, struct Arena * taskArena) {
+    int nameLength = taskName ? (int)strlen(taskName) : 0;
+    if (nameLength >= size) {
+        nameLength = size - 1;
+    }
+
+    memcpy(buffer, taskName ? taskName : "", nameLength);
+    buffer[nameLength] = '\0';
+
+    struct IoCounters taskEnd;
+    if (!taskStart) {
+        return nameLength + 1;
+    }
+
+    // The bytes are sent as 0 when the counters can not be read, so that the use of the arena keeps its place
+    long bytesRead = 0, bytesWritten = 0;
+    if (readIoCounters(&taskEnd)) {
+        bytesRead = taskEnd.bytesRead - taskStart->bytesRead;
+        bytesWritten = taskEnd.bytesWritten - taskStart->bytesWritten;
+    }
+
+    int length;
+    if (taskArena) {
+        length = snprintf(buffer + nameLength + 1, size - nameLength - 1, "%ld %ld %ld %zu", bytesRead, bytesWritten,
+                          taskArena->numberOfAllocations, taskArena->peakBytes);
+    } else {
+        length = snprintf(buffer + nameLength + 1, size - nameLength - 1, "%ld %ld", bytesRead, bytesWritten);
+    }
+
+    // The counters are left out when they do not fit after the name
+    if (length < 0 || length >= size - nameLength - 1) {
+        return nameLength + 1;
+    }
+
+    return nameLength + 1 + length + 1;
+}
+
+/**
+ * Open the Unix-domain socket the metrics are served on
+ * @param socketPath The path of the socket, an existing socket file is replaced
+ * @return The listening socket, or -1 in case it could not be opened
+ */
+static int openMetricsSocket(char * socketPath) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        printf("%sThe metrics socket path %s is too long%s\n", KRED, socketPath, KNRM);
+        return -1;
+    }
+    strcpy(address.sun_path, socketPath);
+
+    int listenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenSocket == -1) {
+        printf("%sCould not create the metrics socket%s\n", KRED, KNRM);
+        return -1;
+    }
+
+    unlink(socketPath);
+    if (bind(listenSocket, (struct sockaddr *)&address, sizeof(address)) == -1 || listen(listenSocket, 8) == -1) {
+        printf("%sCould not listen on the metrics socket %s%s\n", KRED, socketPath, KNRM);
+        close(listenSocket);
+        return -1;
+    }
+
+    return listenSocket;
+}
+
+/**
+ * Initialize the metrics of a run
+ * @param metrics The metrics to initialize
+ * @param numberOfRanks The number of processes, including the master
+ * @param textfilePath The path of the textfile the metrics are written to, or NULL
+ * @param socketPath The path of the Unix-domain socket the metrics are served on, or NULL
+ * @param tracePath The path of the trace of the completed tasks, or NULL
+ */
+void initMetrics(struct Metrics * metrics, int numberOfRanks, char * textfilePath, char * socketPath, char * tracePath) {
+    memset(metrics, 0, sizeof(struct Metrics));
+
+    metrics->numberOfRanks = numberOfRanks;
+    metrics->ranks = (struct RankMetrics *)calloc(numberOfRanks, sizeof(struct RankMetrics));
+    metrics->phase = 1;
+
+    metrics->textfilePath = textfilePath;
+    metrics->socketPath = socketPath;
+    metrics->listenSocket = socketPath ? openMetricsSocket(socketPath) : -1;
+    metrics->trace = tracePath ? openTaskTrace(tracePath) : NULL;
+
+    metrics->startTime = getCurrentTimestamp();
+}
+
+/**
+ * Count a task sent to a worker
+ * @param metrics The metrics
+ * @param rank The worker the task was sent to
+ * @param tag The task code
+ */
+void recordTaskDispatched(struct Metrics * metrics, int rank, int tag) {
+    int index = getMetricsTaskIndex(tag);
+    if (index == -1 || rank <= 0 || rank >= metrics->numberOfRanks) {
+        return;
+    }
+
+    metrics->tasksDispatched[index]++;
+    metrics->tasksInFlight++;
+    metrics->ranks[rank].dispatchTime = getCurrentTimestamp();
+}
+
+/**
+ * Count a task reported by a worker, together with the bytes it moved
+ * @param metrics The metrics
+ * @param rank The worker that reported the task
+ * @param tag The task code
+ * @param message The completion message
+ * @param messageLength The length of the completion message
+ */
+void recordTaskCompleted(struct Metrics * metrics, int rank, int tag, char * message, int messageLength) {
+    int index = getMetricsTaskIndex(tag);
+    if (index == -1 || rank <= 0 || rank >= metrics->numberOfRanks) {
+        return;
+    }
+
+    struct RankMetrics * rankMetrics = metrics->ranks + rank;
+
+    metrics->tasksCompleted[index]++;
+    metrics->tasksInFlight--;
+    rankMetrics->tasksCompleted++;
+
+    int64_t now = getCurrentTimestamp();
+    int64_t dispatchTime = rankMetrics->dispatchTime;
+    if (dispatchTime > 0) {
+        rankMetrics->busyTime += now - dispatchTime;
+        rankMetrics->dispatchTime = 0;
+    }
+
+    int nameLength = (int)strnlen(message, messageLength);
+    long bytesRead = 0, bytesWritten = 0, arenaAllocations = 0, arenaPeakBytes = 0;
+    int numberOfCounters = 0;
+    if (nameLength + 1 < messageLength) {
+        numberOfCounters = sscanf(message + nameLength + 1, "%ld %ld %ld %ld", &bytesRead, &bytesWritten,
+                                  &arenaAllocations, &arenaPeakBytes);
+    }
+
+    if (numberOfCounters >= 2) {
+        rankMetrics->bytesRead += bytesRead;
+        rankMetrics->bytesWritten += bytesWritten;
+    } else {
+        bytesRead = bytesWritten = 0;
+    }
+
+    if (numberOfCounters == 4) {
+        rankMetrics->arenaAllocations += arenaAllocations;
+        if (arenaPeakBytes > rankMetrics->peakArenaBytes) {
+            rankMetrics->peakArenaBytes = arenaPeakBytes;
+        }
+    } else {
+        arenaAllocations = arenaPeakBytes = 0;
+    }
+
+    if (metrics->trace && dispatchTime > 0) {
+        struct TaskTraceRecord record;
+        snprintf(record.stage, MAX_TRACE_STAGE_LENGTH, "%s", getTaskName(tag));
+        record.rank = rank;
+        record.start = dispatchTime - metrics->startTime;
+        record.end = now - metrics->startTime;
+        record.bytesRead = bytesRead;
+        record.bytesWritten = bytesWritten;
+        record.arenaAllocations = arenaAllocations;
+        record.arenaPeakBytes = arenaPeakBytes;
+        record.name = nameLength < messageLength ? message : NULL;
+
+        writeTaskTraceRecord(metrics->trace, &record);
+    }
+}
+
+/**
+ * Write a metric with its help and type lines
+ * @param file The file to write to
+ * @param name The name of the metric
+ * @param type The Prometheus type of the metric
+ * @param help The description of the metric
+ */
+static void writeMetricHeader(FILE * file, char * name, char * type, char * help) {
+    fprintf(file, "# HELP %s %s\n", name, help);
+    fprintf(file, "# TYPE %s %s\n", name, type);
+}
+
+/**
+ * Render the metrics in the Prometheus text format
+ * @param metrics The metrics
+ * @param length Where the length of the text is stored
+ * @return The text, which must be freed by the caller, or NULL in case it could not be rendered
+ */
+static char * renderMetrics(struct Metrics * metrics, size_t * length) {
+    char * text = NULL;
+    FILE * file = open_memstream(&text, length);
+    if (!file) {
+        return NULL;
+    }
+
+    writeMetricHeader(file, "mapreduce_uptime_seconds", "gauge", "Time since the master started scheduling.");
+    fprintf(file, "mapreduce_uptime_seconds %.3f\n", (getCurrentTimestamp() - metrics->startTime) / 1e6);
+
+    writeMetricHeader(file, "mapreduce_phase", "gauge", "The current phase, 1 for the per-file stages, 2 for the reverse index stage, 3 once finished.");
+    fprintf(file, "mapreduce_phase %d\n", metrics->phase);
+
+    writeMetricHeader(file, "mapreduce_files_discovered", "gauge", "Input files discovered so far.");
+    fprintf(file, "mapreduce_files_discovered %ld\n", metrics->filesDiscovered);
+
+    writeMetricHeader(file, "mapreduce_files", "gauge", "Input files by the per-file stage they are waiting for or running.");
+    for (int stage = 0; stage < NUMBER_OF_METRICS_STAGES; stage++) {
+        for (int state = 0; state < NUMBER_OF_METRICS_STATES; state++) {
+            fprintf(file, "mapreduce_files{stage=\"%s\",state=\"%s\"} %ld\n",
+                    getTaskName(metricsTasks[stage]), metricsStates[state], metrics->files[stage][state]);
+        }
+    }
+
+    writeMetricHeader(file, "mapreduce_files_done", "gauge", "Input files that went through all the per-file stages.");
+    fprintf(file, "mapreduce_files_done %ld\n", metrics->filesDone);
+
+    writeMetricHeader(file, "mapreduce_tasks_dispatched_total", "counter", "Tasks sent to the workers.");
+    for (int i = 0; i < NUMBER_OF_METRICS_TASKS; i++) {
+        fprintf(file, "mapreduce_tasks_dispatched_total{task=\"%s\"} %ld\n", getTaskName(metricsTasks[i]), metrics->tasksDispatched[i]);
+    }
+
+    writeMetricHeader(file, "mapreduce_tasks_completed_total", "counter", "Tasks reported by the workers.");
+    for (int i = 0; i < NUMBER_OF_METRICS_TASKS; i++) {
+        fprintf(file, "mapreduce_tasks_completed_total{task=\"%s\"} %ld\n", getTaskName(metricsTasks[i]), metrics->tasksCompleted[i]);
+    }
+
+    writeMetricHeader(file, "mapreduce_tasks_in_flight", "gauge", "Tasks sent to the workers and not reported yet.");
+    fprintf(file, "mapreduce_tasks_in_flight %ld\n", metrics->tasksInFlight);
+
+    writeMetricHeader(file, "mapreduce_queue_depth", "gauge", "Tasks ready to be sent to the next idle worker.");
+    fprintf(file, "mapreduce_queue_depth %ld\n", metrics->queueDepth);
+
+    writeMetricHeader(file, "mapreduce_rank_tasks_completed_total", "counter", "Tasks reported by every worker.");
+    for (int rank = 1; rank < metrics->numberOfRanks; rank++) {
+        fprintf(file, "mapreduce_rank_tasks_completed_total{rank=\"%d\"} %ld\n", rank, metrics->ranks[rank].tasksCompleted);
+    }
+
+    writeMetricHeader(file, "mapreduce_rank_busy_seconds_total", "counter", "Time every worker spent between receiving a task and reporting it.");
+    for (int rank = 1; rank < metrics->numberOfRanks; rank++) {
+        fprintf(file, "mapreduce_rank_busy_seconds_total{rank=\"%d\"} %.3f\n", rank, metrics->ranks[rank].busyTime / 1e6);
+    }
+
+    writeMetricHeader(file, "mapreduce_rank_read_bytes_total", "counter", "Bytes every worker read during its tasks.");
+    for (int rank = 1; rank < metrics->numberOfRanks; rank++) {
+        fprintf(file, "mapreduce_rank_read_bytes_total{rank=\"%d\"} %ld\n", rank, metrics->ranks[rank].bytesRead);
+    }
+
+    writeMetricHeader(file, "mapreduce_rank_written_bytes_total", "counter", "Bytes every worker wrote during its tasks.");
+    for (int rank = 1; rank < metrics->numberOfRanks; rank++) {
+        fprintf(file, "mapreduce_rank_written_bytes_total{rank=\"%d\"} %ld\n", rank, metrics->ranks[rank].bytesWritten);
+    }
+
+    writeMetricHeader(file, "mapreduce_rank_arena_allocations_total", "counter", "Allocations of the tasks of every worker from their arenas.");
+    for (int rank = 1; rank < metrics->numberOfRanks; rank++) {
+        fprintf(file, "mapreduce_rank_arena_allocations_total{rank=\"%d\"} %ld\n", rank, metrics->ranks[rank].arenaAllocations);
+    }
+
+    writeMetricHeader(file, "mapreduce_rank_arena_peak_bytes", "gauge", "Largest arena of a single task of every worker.");
+    for (int rank = 1; rank < metrics->numberOfRanks; rank++) {
+        fprintf(file, "mapreduce_rank_arena_peak_bytes{rank=\"%d\"} %ld\n", rank, metrics->ranks[rank].peakArenaBytes);
+    }
+
+    if (fclose(file) != 0) {
+        free(text);
+        return NULL;
+    }
+
+    return text;
+}
+
+/**
+ * Replace the metrics textfile, the text is written to a temporary file first so that readers never see half of it
+ * @param metrics The metrics
+ * @param text The rendered metrics
+ * @param length The length of the text
+ */
+static void writeMetricsTextfile(struct Metrics * metrics, char * text, size_t length) {
+    char temporaryPath[FILENAME_MAX];
+    snprintf(temporaryPath, FILENAME_MAX, "%s.tmp", metrics->textfilePath);
+
+    FILE * file = fopen(temporaryPath, "w");
+    if (!file) {
+        return;
+    }
+
+    bool written = fwrite(text, 1, length, file) == length;
+    if (fclose(file) != 0 || !written || rename(temporaryPath, metrics->textfilePath) != 0) {
+        unlink(temporaryPath);
+    }
+}
+
+/**
+ * Send a whole buffer to a client of the metrics socket, waiting for room in the socket buffer when it is full
+ * @param client The non blocking socket of the client
+ * @param data The data to send
+ * @param length The length of the data
+ * @param deadline The timestamp, in microseconds, after which the client is given up
+ * @return True or false, whether all the data was sent
+ */
+static bool sendToMetricsClient(int client, const char * data, size_t length, int64_t deadline) {
+    while (length > 0) {
+        ssize_t sent = send(client, data, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+        if (sent > 0) {
+            data += sent;
+            length -= (size_t)sent;
+            continue;
+        }
+
+        if (sent == -1 && errno == EINTR) {
+            continue;
+        }
+
+        int64_t remaining = deadline - getCurrentTimestamp();
+        if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK) && remaining > 0) {
+            struct pollfd writable = { client, POLLOUT, 0 };
+            poll(&writable, 1, (int)((remaining + 999) / 1000));
+            continue;
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Answer every client waiting on the metrics socket, a client that does not take its response within
+ * METRICS_SEND_TIMEOUT is dropped
+ * @param metrics The metrics
+ */
+static void serveMetricsSocket(struct Metrics * metrics) {
+    char * text = NULL;
+    size_t length = 0;
+    int client;
+
+    while ((client = accept4(metrics->listenSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+        if (!text && !(text = renderMetrics(metrics, &length))) {
+            close(client);
+            break;
+        }
+
+        // The request is not needed, every request gets the metrics
+        char request[1024];
+        while (recv(client, request, sizeof(request), MSG_DONTWAIT) > 0);
+
+        char header[128];
+        int headerLength = snprintf(header, sizeof(header),
+                                    "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n\r\n", length);
+
+        int64_t deadline = getCurrentTimestamp() + (int64_t)METRICS_SEND_TIMEOUT * 1000;
+        if (!sendToMetricsClient(client, header, (size_t)headerLength, deadline) ||
+            !sendToMetricsClient(client, text, length, deadline)) {
+            printf("%sROOT -> Could not send the metrics to a client of the metrics socket%s\n", KRED, KNRM);
+        }
+        close(client);
+    }
+
+    free(text);
+}
+
+/**
+ * Update the metrics that are read from the scheduler state
+ * @param metrics The metrics
+ * @param phase The current phase
+ * @param operations The operations table of the per-file stages, or NULL once it is not used anymore
+ * @param numberOfOperations The number of operations
+ * @param queuedTasks The tasks ready to be sent, besides the pending operations of the table
+ */
+void updateMetrics(struct Metrics * metrics, int phase, struct Operation * operations, int numberOfOperations, long queuedTasks) {
+    metrics->phase = phase;
+    metrics->queueDepth = queuedTasks;
+
+    // The counts of the table are kept once it is freed, so the per-file stages stay visible in the next phase
+    if (operations) {
+        memset(metrics->files, 0, sizeof(metrics->files));
+        metrics->filesDone = 0;
+        metrics->filesDiscovered = numberOfOperations;
+
+        for (int i = 0; i < numberOfOperations; i++) {
+            struct Operation * op = operations + i;
+            if (op->lastOperation == Done) {
+                metrics->filesDone++;
+                continue;
+            }
+
+            int stage = getMetricsTaskIndex(getNextTaskForTag(op->lastOperation));
+            if (op->currentOperation == InProgress) {
+                metrics->files[stage][1]++;
+            } else {
+                metrics->files[stage][0]++;
+                metrics->queueDepth++;
+            }
+        }
+    }
+}
+
+/**
+ * Update the metrics and export them when it is time to
+ * Called on every iteration of the scheduler loop, it returns right away until METRICS_POLL_INTERVAL passed
+ * @param metrics The metrics
+ * @param phase The current phase
+ * @param operations The operations table of the per-file stages, or NULL once it is not used anymore
+ * @param numberOfOperations The number of operations
+ * @param queuedTasks The tasks ready to be sent, besides the pending operations of the table
+ */
+void pollMetrics(struct Metrics * metrics, int phase, struct Operation * operations, int numberOfOperations, long queuedTasks) {
+    if (!metrics->textfilePath && metrics->listenSocket == -1) {
+        return;
+    }
+
+    int64_t now = getCurrentTimestamp();
+    if (now - metrics->lastPoll < METRICS_POLL_INTERVAL) {
+        return;
+    }
+    metrics->lastPoll = now;
+
+    updateMetrics(metrics, phase, operations, numberOfOperations, queuedTasks);
+
+    if (metrics->listenSocket != -1) {
+        serveMetricsSocket(metrics);
+    }
+
+    if (metrics->textfilePath && now - metrics->lastExport >= METRICS_EXPORT_INTERVAL) {
+        exportMetrics(metrics);
+    }
+}
+
+/**
+ * Write the metrics textfile right away, used for the final state of a run
+ * @param metrics The metrics
+ */
+void exportMetrics(struct Metrics * metrics) {
+    if (!metrics->textfilePath) {
+        return;
+    }
+
+    size_t length;
+    char * text = renderMetrics(metrics, &length);
+    if (text) {
+        writeMetricsTextfile(metrics, text, length);
+        free(text);
+    }
+
+    metrics->lastExport = getCurrentTimestamp();
+}
+
+/**
+ * Close the metrics socket and free the metrics, the textfile is left in place
+ * @param metrics The metrics to free
+ */
+void freeMetrics(struct Metrics * metrics) {
+    if (metrics->listenSocket != -1) {
+        close(metrics->listenSocket);
+        unlink(metrics->socketPath);
+        metrics->listenSocket = -1;
+    }
+
+    if (metrics->trace) {
+        fclose(metrics->trace);
+        metrics->trace = NULL;
+    }
+
+    free(metrics->ranks);
+    metrics->ranks = NULL;
+}
@@ -0,0 +1,318 @@
+/**
+ * Function library for the positional reverse index
+ *
+ * The positions file of a word holds one record per file the word appears in:
+ * varint(length of file name), file name, varint(number of positions), varint(length of positions), positions
+ * The positions are stored as varint encoded differences between consecutive positions
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../defs/PositionalIndex.h"
+#include "../defs/FileOperations.h"
+#include "../defs/Logging.h"
+
+/**
+ * Encode a value as a varint, 7 bits per byte with the high bit set on all but the last byte
+ * @param value The value to encode
+ * @param buffer The buffer to write to, at least MAX_VARINT_BYTES long
+ * @return The number of bytes written
+ */
+size_t encodeVarint(uint32_t value, unsigned char * buffer) {
+    size_t length = 0;
+
+    while (value >= 0x80) {
+        buffer[length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[length++] = (unsigned char)value;
+
+    return length;
+}
+
+/**
+ * Decode a varint
+ * @param buffer The buffer to read from
+ * @param length The number of bytes available in the buffer
+ * @param value Where the decoded value is stored
+ * @return The number of bytes read, 0 if the buffer does not hold a complete varint
+ */
+size_t decodeVarint(const unsigned char * buffer, size_t length, uint32_t * value) {
+    uint32_t result = 0;
+
+    for (size_t i = 0; i < length && i < MAX_VARINT_BYTES; i++) {
+        result |= (uint32_t)(buffer[i] & 0x7F) << (7 * i);
+
+        if (!(buffer[i] & 0x80)) {
+            *value = result;
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Delta and varint encode a list of increasing positions
+ * @param positions The positions to encode
+ * @param numberOfPositions The number of positions
+ * @param buffer The buffer to write to, at least numberOfPositions * MAX_VARINT_BYTES long
+ * @return The number of bytes written
+ */
+size_t encodePositions(const uint32_t * positions, int numberOfPositions, unsigned char * buffer) {
+    size_t length = 0;
+    uint32_t previous = 0;
+
+    for (int i = 0; i < numberOfPositions; i++) {
+        length += encodeVarint(positions[i] - previous, buffer + length);
+        previous = positions[i];
+    }
+
+    return length;
+}
+
+/**
+ * Decode a list of positions created by encodePositions
+ * @param buffer The buffer to read from
+ * @param length The number of bytes of the buffer
+ * @param positions Where the decoded positions are stored
+ * @param maxPositions The maximum number of positions to decode
+ * @return The number of decoded positions
+ */
+int decodePositions(const unsigned char * buffer, size_t length, uint32_t * positions, int maxPositions) {
+    int numberOfPositions = 0;
+    size_t offset = 0;
+    uint32_t previous = 0;
+
+    while (offset < length && numberOfPositions < maxPositions) {
+        uint32_t delta;
+        size_t read = decodeVarint(buffer + offset, length - offset, &delta);
+        if (read == 0) {
+            break;
+        }
+
+        offset += read;
+        previous += delta;
+        positions[numberOfPositions++] = previous;
+    }
+
+    return numberOfPositions;
+}
+
+/**
+ * Append the record of one posting to the positions file of a word
+ * @param file The positions file of the word
+ * @param fileName The name of the file the word appears in
+ * @param numberOfPositions The number of encoded positions
+ * @param encoded The positions, encoded with encodePositions
+ * @param length The length of the encoded positions
+ * @return True or false, whether the record was written
+ */
+bool writePostingRecord(FILE * file, char * fileName, int numberOfPositions, const unsigned char * encoded, size_t length) {
+    unsigned char header[3 * MAX_VARINT_BYTES];
+    size_t nameLength = strlen(fileName);
+
+    size_t headerLength = encodeVarint((uint32_t)nameLength, header);
+    if (fwrite(header, 1, headerLength, file) != headerLength || fwrite(fileName, 1, nameLength, file) != nameLength) {
+        return false;
+    }
+
+    headerLength = encodeVarint((uint32_t)numberOfPositions, header);
+    headerLength += encodeVarint((uint32_t)length, header + headerLength);
+
+    return fwrite(header, 1, headerLength, file) == headerLength && fwrite(encoded, 1, length, file) == length;
+}
+
+/**
+ * Read a varint from a file stream
+ * @param file The file to read from
+ * @param value Where the decoded value is stored
+ * @return True or false, whether a complete varint was read
+ */
+static bool readVarint(FILE * file, uint32_t * value) {
+    unsigned char buffer[MAX_VARINT_BYTES];
+    int c;
+
+    for (size_t i = 0; i < MAX_VARINT_BYTES && (c = fgetc(file)) != EOF; i++) {
+        buffer[i] = (unsigned char)c;
+        if (!(c & 0x80)) {
+            return decodeVarint(buffer, i + 1, value) != 0;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Read all the postings of a word from its positions file
+ * @param indexDirectory The directory of the positions files
+ * @param word The word to read the postings of
+ * @param list Where the postings are stored, must be freed with freePostingList
+ * @return True or false, whether the positions file of the word could be read
+ */
+bool readPostingList(char * indexDirectory, char * word, struct PostingList * list) {
+    list->postings = NULL;
+    list->numberOfPostings = 0;
+
+    char * path = buildFilePath(indexDirectory, word, NULL);
+    FILE * file = fopen(path, "rb");
+    free(path);
+
+    if (!file) {
+        return false;
+    }
+
+    int capacity = 0;
+    uint32_t nameLength;
+
+    while (readVarint(file, &nameLength)) {
+        uint32_t numberOfPositions, length;
+        char * fileName = (char *)malloc(nameLength + 1);
+
+        if (fread(fileName, 1, nameLength, file) != nameLength ||
+            !readVarint(file, &numberOfPositions) ||
+            !readVarint(file, &length)) {
+            free(fileName);
+            break;
+        }
+        fileName[nameLength] = '\0';
+
+        unsigned char * encoded = (unsigned char *)malloc(length ? length : 1);
+        if (fread(encoded, 1, length, file) != length) {
+            free(encoded);
+            free(fileName);
+            break;
+        }
+
+        if (list->numberOfPostings == capacity) {
+            capacity = capacity ? capacity * 2 : 8;
+            list->postings = (struct Posting *)realloc(list->postings, capacity * sizeof(struct Posting));
+        }
+
+        struct Posting * posting = list->postings + list->numberOfPostings++;
+        posting->fileName = fileName;
+        posting->positions = (uint32_t *)malloc((numberOfPositions ? numberOfPositions : 1) * sizeof(uint32_t));
+        posting->numberOfPositions = decodePositions(encoded, length, posting->positions, (int)numberOfPositions);
+
+        free(encoded);
+    }
+
+    fclose(file);
+    return true;
+}
+
+/**
+ * Free the postings read by readPostingList
+ * @param list The postings to free
+ */
+void freePostingList(struct PostingList * list) {
+    for (int i = 0; i < list->numberOfPostings; i++) {
+        free(list->postings[i].fileName);
+        free(list->postings[i].positions);
+    }
+
+    free(list->postings);
+    list->postings = NULL;
+    list->numberOfPostings = 0;
+}
+
+/**
+ * Check whether a position appears in a posting, by binary search
+ * @param posting The posting to look into
+ * @param position The position to look for
+ * @return True or false, whether the position appears in the posting
+ */
+static bool hasPosition(struct Posting * posting, uint32_t position) {
+    int low = 0;
+    int high = posting->numberOfPositions - 1;
+
+    while (low <= high) {
+        int middle = low + (high - low) / 2;
+
+        if (posting->positions[middle] == position) {
+            return true;
+        } else if (posting->positions[middle] < position) {
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Find the posting of a given file in a posting list
+ * @param list The posting list to look into
+ * @param fileName The name of the file
+ * @return The posting or NULL if the word does not appear in the file
+ */
+static struct Posting * findPosting(struct PostingList * list, char * fileName) {
+    for (int i = 0; i < list->numberOfPostings; i++) {
+        if (strcmp(list->postings[i].fileName, fileName) == 0) {
+            return list->postings + i;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Find the files in which the given words appear one right after the other
+ * @param indexDirectory The directory of the positions files
+ * @param words The words of the phrase, in order
+ * @param numberOfWords The number of words of the phrase
+ * @param matchingFiles Where the array of matching file names is stored, the names and the array must be freed by the caller
+ * @return The number of matching files
+ */
+int findPhrase(char * indexDirectory, char ** words, int numberOfWords, char *** matchingFiles) {
+    *matchingFiles = NULL;
+    if (numberOfWords == 0) {
+        return 0;
+    }
+
+    struct PostingList * lists = (struct PostingList *)calloc(numberOfWords, sizeof(struct PostingList));
+    int numberOfMatches = 0;
+    bool allWordsFound = true;
+
+    for (int i = 0; i < numberOfWords; i++) {
+        allWordsFound = readPostingList(indexDirectory, words[i], lists + i) && allWordsFound;
+    }
+
+    for (int p = 0; allWordsFound && p < lists[0].numberOfPostings; p++) {
+        struct Posting * first = lists[0].postings + p;
+        struct Posting * others[numberOfWords];
+        bool inAllFiles = true;
+
+        for (int i = 1; i < numberOfWords && inAllFiles; i++) {
+            others[i] = findPosting(lists + i, first->fileName);
+            inAllFiles = others[i] != NULL;
+        }
+
+        // Every start position of the first word is checked for the rest of the words at the following offsets
+        for (int s = 0; inAllFiles && s < first->numberOfPositions; s++) {
+            bool adjacent = true;
+
+            for (int i = 1; i < numberOfWords && adjacent; i++) {
+                adjacent = hasPosition(others[i], first->positions[s] + i);
+            }
+
+            if (adjacent) {
+                *matchingFiles = (char **)realloc(*matchingFiles, (numberOfMatches + 1) * sizeof(char *));
+                (*matchingFiles)[numberOfMatches++] = strdup(first->fileName);
+                break;
+            }
+        }
+    }
+
+    for (int i = 0; i < numberOfWords; i++) {
+        freePostingList(lists + i);
+    }
+    free(lists);
+
+    return numberOfMatches;
+}
@@ -0,0 +1,166 @@
+/**
+ * Function library used for precomputing the TF-IDF weights of the reverse index postings
+ *
+ * A ranked reverse index file has the following layout:
+ *  df {documentFrequency} idf {inverseDocumentFrequency}
+ *  top {k}
+ *  {fileName} {count} {weight}     k lines, by decreasing weight
+ *  all {documentFrequency}
+ *  {fileName} {count} {weight}     one line per posting
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "../defs/Ranking.h"
+#include "../defs/DirectoryStream.h"
+#include "../defs/FileOperations.h"
+
+/**
+ * Read the document lengths written by the map stage, one file per input file containing its number of words
+ * @param directoryName The directory of the document lengths
+ * @param documentLengths The counter in which the lengths are stored, keyed by file name
+ * @return True or false, whether the directory could be read
+ */
+bool loadDocumentLengths(char * directoryName, struct WordCounter * documentLengths) {
+    struct DirectoryStream * stream = openDirectoryStream(directoryName, false);
+    if (!stream) {
+        return false;
+    }
+
+    char * names[DIRECTORY_BATCH_SIZE];
+    int numberOfNames;
+
+    while ((numberOfNames = readDirectoryBatch(stream, names, DIRECTORY_BATCH_SIZE, NULL)) > 0) {
+        for (int i = 0; i < numberOfNames; i++) {
+            char * path = buildFilePath(directoryName, names[i], NULL);
+            FILE * file = fopen(path, "r");
+            long length = 0;
+
+            if (file) {
+                if (fscanf(file, "%ld", &length) != 1) {
+                    length = 0;
+                }
+                fclose(file);
+            }
+
+            incrementWord(documentLengths, names[i], length);
+
+            free(path);
+            free(names[i]);
+        }
+    }
+
+    closeDirectoryStream(stream);
+    return true;
+}
+
+/**
+ * Compute the smoothed inverse document frequency of a word, log(1 + N / df),
+ * so that words appearing in every file still get a non-zero weight
+ * @param numberOfDocuments The total number of files
+ * @param documentFrequency The number of files the word appears in
+ * @return The inverse document frequency
+ */
+double computeInverseDocumentFrequency(long numberOfDocuments, long documentFrequency) {
+    if (documentFrequency <= 0) {
+        return 0.0;
+    }
+
+    return log(1.0 + (double)numberOfDocuments / (double)documentFrequency);
+}
+
+/**
+ * Restore the min-heap property from a given node downwards
+ * @param heap The heap, ordered by weight
+ * @param size The number of postings in the heap
+ * @param index The node to sift down
+ */
+static void siftDown(struct WeightedPosting * heap, int size, int index) {
+    while (true) {
+        int smallest = index;
+        int left = 2 * index + 1;
+        int right = left + 1;
+
+        if (left < size && heap[left].weight < heap[smallest].weight) { smallest = left; }
+        if (right < size && heap[right].weight < heap[smallest].weight) { smallest = right; }
+        if (smallest == index) { return; }
+
+        struct WeightedPosting swap = heap[index];
+        heap[index] = heap[smallest];
+        heap[smallest] = swap;
+        index = smallest;
+    }
+}
+
+/**
+ * Select the k postings with the highest weight, using a min-heap of size k
+ * @param postings The postings to select from
+ * @param numberOfPostings The number of postings
+ * @param k The number of postings to select
+ * @param top Where the selected postings are stored by decreasing weight, at least k long
+ * @return The number of selected postings
+ */
+int selectTopPostings(struct WeightedPosting * postings, int numberOfPostings, int k, struct WeightedPosting * top) {
+    int size = 0;
+
+    for (int i = 0; i < numberOfPostings && k > 0; i++) {
+        if (size < k) {
+            top[size++] = postings[i];
+
+            if (size == k) {
+                for (int j = size / 2 - 1; j >= 0; j--) {
+                    siftDown(top, size, j);
+                }
+            }
+        } else if (postings[i].weight > top[0].weight) {
+            top[0] = postings[i];
+            siftDown(top, size, 0);
+        }
+    }
+
+    if (size < k) {
+        for (int j = size / 2 - 1; j >= 0; j--) {
+            siftDown(top, size, j);
+        }
+    }
+
+    // Pop the minimum to the end of the array until the heap is empty, leaving the postings by decreasing weight
+    for (int last = size - 1; last > 0; last--) {
+        struct WeightedPosting swap = top[0];
+        top[0] = top[last];
+        top[last] = swap;
+        siftDown(top, last, 0);
+    }
+
+    return size;
+}
+
+/**
+ * Write the postings of a word, preceded by the block of its k highest weighted postings
+ * @param file The reverse index file of the word
+ * @param postings The postings of the word, with their weights computed
+ * @param numberOfPostings The number of postings
+ * @param k The maximum number of postings of the top block
+ * @param idf The inverse document frequency of the word
+ */
+void writeRankedPostings(FILE * file, struct WeightedPosting * postings, int numberOfPostings, int k, double idf) {
+    struct WeightedPosting * top = (struct WeightedPosting *)malloc((k > 0 ? k : 1) * sizeof(struct WeightedPosting));
+    int numberOfTopPostings = selectTopPostings(postings, numberOfPostings, k, top);
+
+    fprintf(file, "df %d idf %.6f\n", numberOfPostings, idf);
+
+    fprintf(file, "top %d\n", numberOfTopPostings);
+    for (int i = 0; i < numberOfTopPostings; i++) {
+        fprintf(file, "%s %ld %.6f\n", top[i].fileName, top[i].count, top[i].weight);
+    }
+
+    fprintf(file, "all %d\n", numberOfPostings);
+    for (int i = 0; i < numberOfPostings; i++) {
+        fprintf(file, "%s %ld %.6f\n", postings[i].fileName, postings[i].count, postings[i].weight);
+    }
+
+    free(top);
+}
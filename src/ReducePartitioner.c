@@ -0,0 +1,307 @@
+/**
+ * Function library used for grouping the words of the final reverse index stage into tasks of similar cost
+ *
+ * The cost of reverse-indexing a word grows with its number of postings, which is estimated with the
+ * frequency sketch built during the direct index stage. Words are packed into batches until the estimated
+ * volume of the batch reaches the target volume, and the words estimated above the target volume are split
+ * into several parts, each reverse-indexed by a different worker and concatenated by a merge task.
+ * Without a sketch every word is a task of its own.
+ * A word is only split when the names of the files of its parts fit in a file name, see formatReducePartName.
+ *
+ * Task messages:
+ *  TASK_REVERSE_INDEX_WORD     {word}\n{word}\n...{word}
+ *  TASK_REVERSE_INDEX_PART     {word}\t{part}/{numberOfParts}
+ *  TASK_REVERSE_INDEX_MERGE    {word}\t{numberOfParts}
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "../defs/ReducePartitioner.h"
+#include "../defs/MapReduceOperation.h"
+
+/**
+ * Initialize an empty partitioner
+ * @param partitioner The partitioner to initialize
+ * @param sketch The estimated number of postings of every word, or NULL to send every word on its own
+ * @param numberOfWorkers The number of workers of the final stage
+ * @param targetVolume The estimated number of postings of a task, or 0 to compute it from the sketch
+ */
+void initReducePartitioner(struct ReducePartitioner * partitioner, struct FrequencySketch * sketch,
+                           int numberOfWorkers, long targetVolume) {
+    memset(partitioner, 0, sizeof(struct ReducePartitioner));
+    partitioner->sketch = sketch;
+
+    if (targetVolume <= 0 && sketch) {
+        targetVolume = sketch->total / ((long)(numberOfWorkers > 0 ? numberOfWorkers : 1) * REDUCE_TASKS_PER_WORKER);
+        if (targetVolume < MIN_REDUCE_VOLUME) {
+            targetVolume = MIN_REDUCE_VOLUME;
+        }
+    }
+    partitioner->targetVolume = targetVolume > 0 ? targetVolume : 1;
+    partitioner->maxParts = numberOfWorkers < MAX_REDUCE_PARTS ? numberOfWorkers : MAX_REDUCE_PARTS;
+
+    partitioner->batch = (char *)malloc(MAX_TASK_MESSAGE_SIZE);
+    partitioner->batch[0] = '\0';
+}
+
+/**
+ * Add a task at the end of the queue
+ * @param partitioner The partitioner
+ * @param tag The tag of the task
+ * @param message The message of the task, it is copied
+ */
+void queueReduceTask(struct ReducePartitioner * partitioner, int tag, char * message) {
+    if (partitioner->numberOfTasks == partitioner->tasksCapacity) {
+        // Reuse the space of the tasks that were already handed out before growing the queue
+        if (partitioner->firstTask > 0) {
+            partitioner->numberOfTasks -= partitioner->firstTask;
+            memmove(partitioner->tasks, partitioner->tasks + partitioner->firstTask,
+                    partitioner->numberOfTasks * sizeof(struct ReduceTask));
+            partitioner->firstTask = 0;
+        }
+
+        if (partitioner->numberOfTasks == partitioner->tasksCapacity) {
+            partitioner->tasksCapacity = partitioner->tasksCapacity ? partitioner->tasksCapacity * 2 : 64;
+            partitioner->tasks = (struct ReduceTask *)realloc(partitioner->tasks,
+                                                              partitioner->tasksCapacity * sizeof(struct ReduceTask));
+        }
+    }
+
+    struct ReduceTask * task = partitioner->tasks + partitioner->numberOfTasks++;
+    task->tag = tag;
+    task->message = strdup(message);
+}
+
+/**
+ * Build the name of the file a part of a split word is written to, {word}_{part} or {word}_{part}_positions
+ * @param buffer Where the name is built, at least NAME_MAX + 1 long
+ * @param word The split word
+ * @param part The part
+ * @param positions Whether it is the name of the positions of the part
+ * @return True or false, whether the name fits in a file name
+ */
+bool formatReducePartName(char * buffer, char * word, int part, bool positions) {
+    int length = snprintf(buffer, NAME_MAX + 1, positions ? "%s_%d_positions" : "%s_%d", word, part);
+
+    return length >= 0 && length <= NAME_MAX;
+}
+
+/**
+ * Queue the parts of a word that is too big for a single task
+ * @param partitioner The partitioner
+ * @param word The word to split
+ * @param numberOfParts The number of parts
+ */
+static void splitReduceWord(struct ReducePartitioner * partitioner, char * word, int numberOfParts) {
+    if (partitioner->numberOfSplitWords == partitioner->splitWordsCapacity) {
+        partitioner->splitWordsCapacity = partitioner->splitWordsCapacity ? partitioner->splitWordsCapacity * 2 : 16;
+        partitioner->splitWords = (struct SplitWord *)realloc(partitioner->splitWords,
+                                                              partitioner->splitWordsCapacity * sizeof(struct SplitWord));
+    }
+
+    struct SplitWord * splitWord = partitioner->splitWords + partitioner->numberOfSplitWords++;
+    splitWord->word = strdup(word);
+    splitWord->numberOfParts = splitWord->remainingParts = numberOfParts;
+
+    for (int part = 0; part < numberOfParts; part++) {
+        char message[FILENAME_MAX];
+        snprintf(message, FILENAME_MAX, "%s%c%d/%d", word, REDUCE_PART_SEPARATOR, part, numberOfParts);
+        queueReduceTask(partitioner, TASK_REVERSE_INDEX_PART, message);
+    }
+
+    partitioner->totalSplitWords++;
+}
+
+/**
+ * Add a word of the final stage, the word ends up either in the current batch or split into parts
+ * @param partitioner The partitioner
+ * @param word The word
+ */
+void addReduceWord(struct ReducePartitioner * partitioner, char * word) {
+    if (!partitioner->sketch) {
+        queueReduceTask(partitioner, TASK_REVERSE_INDEX_WORD, word);
+        partitioner->totalBatches++;
+        return;
+    }
+
+    // The noise of the sketch is subtracted from its estimates, so rare words can get 0, but every word has a posting
+    long volume = estimateFrequency(partitioner->sketch, word);
+    if (volume < 1) {
+        volume = 1;
+    }
+
+    if (volume > partitioner->targetVolume && partitioner->maxParts > 1) {
+        long numberOfParts = (volume + partitioner->targetVolume - 1) / partitioner->targetVolume;
+        if (numberOfParts > partitioner->maxParts) {
+            numberOfParts = partitioner->maxParts;
+        }
+
+        // A word too long for the names of its parts stays a task of its own
+        char partName[NAME_MAX + 1];
+        if (formatReducePartName(partName, word, (int)numberOfParts - 1, true)) {
+            splitReduceWord(partitioner, word, (int)numberOfParts);
+            return;
+        }
+    }
+
+    int wordLength = (int)strlen(word);
+    if (partitioner->batchLength > 0 &&
+        (partitioner->batchVolume + volume > partitioner->targetVolume ||
+         partitioner->batchLength + wordLength + 2 > MAX_TASK_MESSAGE_SIZE)) {
+        flushReduceBatch(partitioner);
+    }
+
+    if (partitioner->batchLength > 0) {
+        partitioner->batch[partitioner->batchLength++] = '\n';
+    }
+    memcpy(partitioner->batch + partitioner->batchLength, word, wordLength + 1);
+    partitioner->batchLength += wordLength;
+    partitioner->batchVolume += volume;
+}
+
+/**
+ * Queue the current batch of words as a task, if it has any words
+ * @param partitioner The partitioner
+ */
+void flushReduceBatch(struct ReducePartitioner * partitioner) {
+    if (partitioner->batchLength == 0) {
+        return;
+    }
+
+    queueReduceTask(partitioner, TASK_REVERSE_INDEX_WORD, partitioner->batch);
+    partitioner->totalBatches++;
+
+    partitioner->batch[0] = '\0';
+    partitioner->batchLength = 0;
+    partitioner->batchVolume = 0;
+}
+
+/**
+ * Check if there are tasks ready to be sent
+ * @param partitioner The partitioner
+ * @return True or false, whether the queue has any tasks
+ */
+bool hasReduceTasks(struct ReducePartitioner * partitioner) {
+    return partitioner->firstTask < partitioner->numberOfTasks;
+}
+
+/**
+ * Get the number of tasks ready to be sent
+ * @param partitioner The partitioner
+ * @return The number of tasks in the queue
+ */
+int getNumberOfQueuedReduceTasks(struct ReducePartitioner * partitioner) {
+    return partitioner->numberOfTasks - partitioner->firstTask;
+}
+
+/**
+ * Take the next task out of the queue
+ * @param partitioner The partitioner
+ * @param task Where the task is stored, its message must be freed by the caller
+ * @return True or false, whether there was a task in the queue
+ */
+bool getNextReduceTask(struct ReducePartitioner * partitioner, struct ReduceTask * task) {
+    if (!hasReduceTasks(partitioner)) {
+        return false;
+    }
+
+    *task = partitioner->tasks[partitioner->firstTask++];
+    if (partitioner->firstTask == partitioner->numberOfTasks) {
+        partitioner->firstTask = partitioner->numberOfTasks = 0;
+    }
+
+    return true;
+}
+
+/**
+ * Parse the message of a part or merge task
+ * @param message The message, {word}\t{part}/{numberOfParts} or {word}\t{numberOfParts}
+ * @param word Where the word is stored, at least FILENAME_MAX long
+ * @param part Where the part is stored, 0 for a merge message
+ * @param numberOfParts Where the number of parts is stored
+ * @return True or false, whether the message is well formed
+ */
+bool parseReducePart(char * message, char * word, int * part, int * numberOfParts) {
+    char * separator = strchr(message, REDUCE_PART_SEPARATOR);
+    if (!separator || separator - message >= FILENAME_MAX) {
+        return false;
+    }
+
+    memcpy(word, message, separator - message);
+    word[separator - message] = '\0';
+
+    if (strchr(separator + 1, '/')) {
+        if (sscanf(separator + 1, "%d/%d", part, numberOfParts) != 2) {
+            return false;
+        }
+    } else {
+        *part = 0;
+        if (sscanf(separator + 1, "%d", numberOfParts) != 1) {
+            return false;
+        }
+    }
+
+    return *numberOfParts > 0 && *part >= 0 && *part < *numberOfParts;
+}
+
+/**
+ * Mark a part of a split word as reverse-indexed, the merge task of the word is queued after its last part
+ * @param partitioner The partitioner
+ * @param message The message of the completed part task
+ * @return True or false, whether the merge task of the word was queued
+ */
+bool completeReducePart(struct ReducePartitioner * partitioner, char * message) {
+    char word[FILENAME_MAX];
+    int part, numberOfParts;
+    if (!parseReducePart(message, word, &part, &numberOfParts)) {
+        return false;
+    }
+
+    for (int i = 0; i < partitioner->numberOfSplitWords; i++) {
+        struct SplitWord * splitWord = partitioner->splitWords + i;
+        if (strcmp(splitWord->word, word) != 0) {
+            continue;
+        }
+
+        if (--splitWord->remainingParts > 0) {
+            return false;
+        }
+
+        // The word came out of a part message, so the merge message is not longer than it
+        char mergeMessage[FILENAME_MAX];
+        int mergeLength = snprintf(mergeMessage, FILENAME_MAX, "%s%c%d", word, REDUCE_PART_SEPARATOR, splitWord->numberOfParts);
+        if (mergeLength < 0 || mergeLength >= FILENAME_MAX) {
+            return false;
+        }
+        queueReduceTask(partitioner, TASK_REVERSE_INDEX_MERGE, mergeMessage);
+
+        free(splitWord->word);
+        *splitWord = partitioner->splitWords[--partitioner->numberOfSplitWords];
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Free a partitioner, including the tasks that were not handed out
+ * @param partitioner The partitioner to free
+ */
+void freeReducePartitioner(struct ReducePartitioner * partitioner) {
+    for (int i = partitioner->firstTask; i < partitioner->numberOfTasks; i++) {
+        free(partitioner->tasks[i].message);
+    }
+    for (int i = 0; i < partitioner->numberOfSplitWords; i++) {
+        free(partitioner->splitWords[i].word);
+    }
+
+    free(partitioner->tasks);
+    free(partitioner->splitWords);
+    free(partitioner->batch);
+    memset(partitioner, 0, sizeof(struct ReducePartitioner));
+}
@@ -0,0 +1,83 @@
+/**
+ * Function library used for parsing the command line options of a MapReduce run
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../defs/RunOptions.h"
+#include "../defs/Ranking.h"
+#include "../defs/SharedShuffle.h"
+#include "../defs/Logging.h"
+
+/**
+ * Parse the command line options, every process parses them on its own
+ * Supported options:
+ *  --recursive             Descend into the subdirectories of the input directory
+ *  --jobs={job},{job}      Run the given built-in jobs on the same pass over the input
+ *  --positional            Also index the positions of the words, for phrase queries
+ *  --tfidf                 Precompute the TF-IDF weights and the top postings of every word
+ *  --top={k}               The number of postings of the top block, 10 by default
+ *  --lexicon               Build a perfect hash lexicon of the reverse index
+ *  --balance[={volume}]    Group the words of the final stage by their estimated number of postings,
+ *                          and split the heaviest ones, the volume of a task is computed when not given
+ *  --metrics-file={path}   Rewrite the live metrics of the master to a Prometheus textfile every second
+ *  --metrics-socket={path} Serve the live metrics of the master on a Unix-domain socket
+ *  --shared-shuffle[={MB}] Hand the words of a file to the direct index through memory shared by the ranks of a node,
+ *                          with a segment of the given size per worker, 64MB by default
+ *  --trace={path}          Record the stage, worker, times and bytes of every completed task, for the scheduler simulator
+ *  --distributed           Schedule the tasks without a master, every rank steals tasks from the others once its own are done
+ * @param argc The number of arguments
+ * @param argv The arguments
+ * @return The parsed options
+ */
+struct RunOptions parseRunOptions(int argc, char ** argv) {
+    struct RunOptions options;
+    memset(&options, 0, sizeof(options));
+    options.topPostings = DEFAULT_TOP_POSTINGS;
+    options.sharedSegmentMegabytes = DEFAULT_SHARED_SEGMENT_MEGABYTES;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--recursive") == 0) {
+            options.recursiveInput = true;
+        } else if (strcmp(argv[i], "--tfidf") == 0) {
+            options.rankedIndex = true;
+        } else if (strncmp(argv[i], "--top=", 6) == 0) {
+            options.topPostings = atoi(argv[i] + 6);
+        } else if (strcmp(argv[i], "--lexicon") == 0) {
+            options.buildLexicon = true;
+        } else if (strcmp(argv[i], "--balance") == 0) {
+            options.balanceReduce = true;
+        } else if (strncmp(argv[i], "--balance=", 10) == 0) {
+            options.balanceReduce = true;
+            options.reduceVolume = atol(argv[i] + 10);
+        } else if (strncmp(argv[i], "--metrics-file=", 15) == 0) {
+            options.metricsFile = argv[i] + 15;
+        } else if (strncmp(argv[i], "--metrics-socket=", 17) == 0) {
+            options.metricsSocket = argv[i] + 17;
+        } else if (strcmp(argv[i], "--shared-shuffle") == 0) {
+            options.sharedShuffle = true;
+        } else if (strncmp(argv[i], "--shared-shuffle=", 17) == 0) {
+            options.sharedShuffle = true;
+            options.sharedSegmentMegabytes = atol(argv[i] + 17);
+        } else if (strncmp(argv[i], "--trace=", 8) == 0) {
+            options.tracePath = argv[i] + 8;
+        } else if (strcmp(argv[i], "--distributed") == 0) {
+            options.distributedScheduling = true;
+        } else if (strcmp(argv[i], "--positional") == 0) {
+            options.positionalIndex = true;
+        } else if (strncmp(argv[i], "--jobs=", 7) == 0) {
+            options.jobs = argv[i] + 7;
+        } else {
+            printf("%sIgnoring unknown option %s%s\n", KRED, argv[i], KNRM);
+        }
+    }
+
+    // Reading /proc/self/io around every task is only worth it when the bytes are exported
+    options.countTaskIo = options.metricsFile || options.metricsSocket || options.tracePath;
+
+    return options;
+}
@@ -0,0 +1,357 @@
+/**
+ * Function library for handing the map output of a file to the ranks of the same node through shared memory
+ *
+ * Every worker allocates a segment of a window shared by all the ranks of its node, and appends the words of
+ * the files it maps to it as records, instead of creating a file per word in the temporary directory.
+ * The direct index task of a file is then sent to a rank of the same node, which reads the record in place.
+ * A worker marks the report of a map task when the words stayed in its segment, the files that did not fit
+ * or were compressed go through the temporary directory and can be direct-indexed by any rank.
+ * Records are only appended, a consumed record is flagged by its consumer and the segment is reused
+ * once all of its records are consumed.
+ * The ranks keep a passive target epoch open on the window, the writes of a producer are made visible with
+ * MPI_Win_sync before it reports its task, and the consumer syncs again once the master hands it the task.
+ *
+ * Segment layout:
+ *  struct SharedSegmentHeader
+ *  struct SharedRecordHeader, {name}\0, {word}\0{word}\0...     once per record, aligned to 8 bytes
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../defs/SharedShuffle.h"
+#include "../defs/MapReduceOperation.h"
+#include "../defs/Logging.h"
+
+/**
+ * Round an offset up to the alignment of the record headers
+ * @param offset The offset to align
+ * @return The aligned offset
+ */
+static size_t alignRecord(size_t offset) {
+    return (offset + 7) & ~(size_t)7;
+}
+
+/**
+ * Set up the shared segments of every node, collective over all the ranks
+ * The shuffle stays disabled when it was not requested, when every rank runs on a node of its own,
+ * or when a shared window could not be allocated
+ * @param shuffle The shuffle to initialize
+ * @param requested Whether the shared shuffle was requested, it must be the same on all the ranks
+ * @param segmentSize The size of the segment of every worker, in bytes
+ * @param isWorker Whether the current rank maps files, the master does not get a segment
+ */
+void initSharedShuffle(struct SharedShuffle * shuffle, bool requested, size_t segmentSize, bool isWorker) {
+    memset(shuffle, 0, sizeof(struct SharedShuffle));
+    shuffle->nodeComm = MPI_COMM_NULL;
+    shuffle->window = MPI_WIN_NULL;
+
+    if (!requested) {
+        return;
+    }
+
+    int worldSize, worldRank;
+    MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &shuffle->nodeComm);
+    MPI_Comm_rank(shuffle->nodeComm, &shuffle->nodeRank);
+    MPI_Comm_size(shuffle->nodeComm, &shuffle->nodeSize);
+
+    int largestNode;
+    MPI_Allreduce(&shuffle->nodeSize, &largestNode, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if (largestNode < 2) {
+        if (worldRank == ROOT) {
+            printf("%sEvery rank runs on a node of its own, the map output goes through the file system%s\n", KYEL, KNRM);
+        }
+        MPI_Comm_free(&shuffle->nodeComm);
+        return;
+    }
+
+    // A node is identified by the lowest rank running on it
+    int node;
+    MPI_Allreduce(&worldRank, &node, 1, MPI_INT, MPI_MIN, shuffle->nodeComm);
+
+    shuffle->nodeOfRank = (int *)malloc(worldSize * sizeof(int));
+    shuffle->nodeRankOfRank = (int *)malloc(worldSize * sizeof(int));
+    MPI_Allgather(&node, 1, MPI_INT, shuffle->nodeOfRank, 1, MPI_INT, MPI_COMM_WORLD);
+    MPI_Allgather(&shuffle->nodeRank, 1, MPI_INT, shuffle->nodeRankOfRank, 1, MPI_INT, MPI_COMM_WORLD);
+
+    if (segmentSize < sizeof(struct SharedSegmentHeader)) {
+        segmentSize = sizeof(struct SharedSegmentHeader);
+    }
+
+    // A failed allocation disables the shuffle on all the ranks, instead of aborting the run
+    char * base = NULL;
+    MPI_Comm_set_errhandler(shuffle->nodeComm, MPI_ERRORS_RETURN);
+    int allocated = MPI_Win_allocate_shared(isWorker ? (MPI_Aint)segmentSize : 0, 1, MPI_INFO_NULL,
+                                            shuffle->nodeComm, &base, &shuffle->window) == MPI_SUCCESS;
+    int allAllocated;
+    MPI_Allreduce(&allocated, &allAllocated, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+
+    if (!allAllocated) {
+        if (worldRank == ROOT) {
+            printf("%sCould not allocate the shared segments, the map output goes through the file system%s\n", KRED, KNRM);
+        }
+        if (allocated) {
+            MPI_Win_free(&shuffle->window);
+        }
+        freeSharedShuffle(shuffle);
+        return;
+    }
+
+    if (isWorker) {
+        struct SharedSegmentHeader * header = (struct SharedSegmentHeader *)base;
+        header->used = alignRecord(sizeof(struct SharedSegmentHeader));
+        header->numberOfRecords = 0;
+    }
+
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, shuffle->window);
+    MPI_Win_sync(shuffle->window);
+    MPI_Barrier(shuffle->nodeComm);
+    MPI_Win_sync(shuffle->window);
+
+    shuffle->segments = (char **)malloc(shuffle->nodeSize * sizeof(char *));
+    shuffle->segmentSizes = (size_t *)malloc(shuffle->nodeSize * sizeof(size_t));
+    for (int i = 0; i < shuffle->nodeSize; i++) {
+        MPI_Aint size;
+        int displacementUnit;
+        MPI_Win_shared_query(shuffle->window, i, &size, &displacementUnit, &shuffle->segments[i]);
+        shuffle->segmentSizes[i] = (size_t)size;
+    }
+
+    shuffle->enabled = true;
+}
+
+/**
+ * Start the record of a file in the segment of the current rank
+ * @param shuffle The shuffle
+ * @param name The name of the file
+ * @param maximumLength An upper bound of the length of the words of the file, with their terminators
+ * @return True or false, whether the record was started, otherwise the map output goes through the file system
+ */
+bool beginMapOutput(struct SharedShuffle * shuffle, char * name, size_t maximumLength) {
+    if (!shuffle->enabled || shuffle->segmentSizes[shuffle->nodeRank] == 0) {
+        return false;
+    }
+
+    char * segment = shuffle->segments[shuffle->nodeRank];
+    size_t segmentSize = shuffle->segmentSizes[shuffle->nodeRank];
+    struct SharedSegmentHeader * header = (struct SharedSegmentHeader *)segment;
+
+    // The consumed flags are written by the other ranks of the node
+    MPI_Win_sync(shuffle->window);
+
+    bool allConsumed = true;
+    size_t offset = alignRecord(sizeof(struct SharedSegmentHeader));
+    for (uint64_t i = 0; i < header->numberOfRecords && allConsumed; i++) {
+        struct SharedRecordHeader * record = (struct SharedRecordHeader *)(segment + offset);
+        allConsumed = record->consumed;
+        offset = alignRecord(offset + sizeof(struct SharedRecordHeader) + record->nameLength + 1 + record->dataLength);
+    }
+
+    if (allConsumed) {
+        header->used = alignRecord(sizeof(struct SharedSegmentHeader));
+        header->numberOfRecords = 0;
+    }
+
+    size_t nameLength = strlen(name);
+    size_t recordLength = sizeof(struct SharedRecordHeader) + nameLength + 1 + maximumLength;
+    if (header->used + recordLength > segmentSize) {
+        return false;
+    }
+
+    shuffle->recordStart = header->used;
+    memcpy(segment + shuffle->recordStart + sizeof(struct SharedRecordHeader), name, nameLength + 1);
+    shuffle->recordCursor = shuffle->recordStart + sizeof(struct SharedRecordHeader) + nameLength + 1;
+    shuffle->recordWords = 0;
+    shuffle->recordOpen = true;
+
+    return true;
+}
+
+/**
+ * Append a word to the record that is being written
+ * @param shuffle The shuffle
+ * @param word The word
+ * @return True or false, whether the word fit in the segment
+ */
+bool appendMapOutput(struct SharedShuffle * shuffle, char * word) {
+    size_t length = strlen(word) + 1;
+    if (shuffle->recordCursor + length > shuffle->segmentSizes[shuffle->nodeRank]) {
+        return false;
+    }
+
+    memcpy(shuffle->segments[shuffle->nodeRank] + shuffle->recordCursor, word, length);
+    shuffle->recordCursor += length;
+    shuffle->recordWords++;
+
+    return true;
+}
+
+/**
+ * Publish the record that is being written, it has to be done before the map task is reported
+ * @param shuffle The shuffle
+ */
+void commitMapOutput(struct SharedShuffle * shuffle) {
+    char * segment = shuffle->segments[shuffle->nodeRank];
+    struct SharedSegmentHeader * header = (struct SharedSegmentHeader *)segment;
+    struct SharedRecordHeader * record = (struct SharedRecordHeader *)(segment + shuffle->recordStart);
+    char * name = segment + shuffle->recordStart + sizeof(struct SharedRecordHeader);
+
+    record->consumed = 0;
+    record->nameLength = (uint32_t)strlen(name);
+    record->numberOfWords = shuffle->recordWords;
+    record->padding = 0;
+    record->dataLength = shuffle->recordCursor - (shuffle->recordStart + sizeof(struct SharedRecordHeader) + record->nameLength + 1);
+
+    header->used = alignRecord(shuffle->recordCursor);
+    header->numberOfRecords++;
+    shuffle->recordOpen = false;
+
+    MPI_Win_sync(shuffle->window);
+}
+
+/**
+ * Give up the record that is being written, so that its words can be written to the file system instead
+ * @param shuffle The shuffle
+ * @param numberOfWords Where the number of words of the record is stored
+ * @return The words of the record, valid until the next record is started
+ */
+char * abandonMapOutput(struct SharedShuffle * shuffle, uint32_t * numberOfWords) {
+    char * name = shuffle->segments[shuffle->nodeRank] + shuffle->recordStart + sizeof(struct SharedRecordHeader);
+
+    *numberOfWords = shuffle->recordWords;
+    shuffle->recordOpen = false;
+
+    return name + strlen(name) + 1;
+}
+
+/**
+ * Find the record of a file in the segment of the rank that mapped it
+ * @param shuffle The shuffle
+ * @param name The name of the file
+ * @param producerRank The rank that mapped the file, -1 when it is not known
+ * @return The record, or NULL in case the file was mapped to the file system
+ */
+struct SharedRecordHeader * findMapOutput(struct SharedShuffle * shuffle, char * name, int producerRank) {
+    if (!shuffle->enabled || producerRank < 0) {
+        return NULL;
+    }
+
+    int worldRank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+    if (shuffle->nodeOfRank[producerRank] != shuffle->nodeOfRank[worldRank]) {
+        return NULL;
+    }
+
+    int nodeRank = shuffle->nodeRankOfRank[producerRank];
+    char * segment = shuffle->segments[nodeRank];
+    if (shuffle->segmentSizes[nodeRank] == 0) {
+        return NULL;
+    }
+
+    MPI_Win_sync(shuffle->window);
+
+    // The producer only appends while this record is not consumed, so the records read here do not change
+    struct SharedSegmentHeader * header = (struct SharedSegmentHeader *)segment;
+    uint64_t numberOfRecords = header->numberOfRecords;
+    size_t offset = alignRecord(sizeof(struct SharedSegmentHeader));
+
+    for (uint64_t i = 0; i < numberOfRecords; i++) {
+        struct SharedRecordHeader * record = (struct SharedRecordHeader *)(segment + offset);
+        char * recordName = segment + offset + sizeof(struct SharedRecordHeader);
+
+        if (!record->consumed && strcmp(recordName, name) == 0) {
+            return record;
+        }
+
+        offset = alignRecord(offset + sizeof(struct SharedRecordHeader) + record->nameLength + 1 + record->dataLength);
+    }
+
+    return NULL;
+}
+
+/**
+ * Get the words of a record
+ * @param record The record
+ * @return The first word, the others follow it, each after the terminator of the previous one
+ */
+char * getMapOutputWords(struct SharedRecordHeader * record) {
+    return (char *)(record + 1) + record->nameLength + 1;
+}
+
+/**
+ * Flag a record as consumed, so that its producer can reuse the space
+ * @param shuffle The shuffle
+ * @param record The record
+ */
+void releaseMapOutput(struct SharedShuffle * shuffle, struct SharedRecordHeader * record) {
+    record->consumed = 1;
+    MPI_Win_sync(shuffle->window);
+}
+
+/**
+ * Mark the report of a map task whose record was committed, after the task name and the optional I/O counters
+ * The counters are dropped when both do not fit in the report
+ * @param report The report, built by formatTaskReport
+ * @param reportLength The length of the report, including its terminating characters
+ * @param size The size of the report buffer
+ * @return The length of the marked report
+ */
+int appendSharedOutputMarker(char * report, int reportLength, int size) {
+    int markerSize = (int)sizeof(SHARED_OUTPUT_MARKER);
+
+    if (reportLength + markerSize > size) {
+        reportLength = (int)strlen(report) + 1;
+    }
+
+    memcpy(report + reportLength, SHARED_OUTPUT_MARKER, markerSize);
+    return reportLength + markerSize;
+}
+
+/**
+ * Check whether the report of a map task was marked by appendSharedOutputMarker
+ * @param report The report
+ * @param reportLength The length of the report, including its terminating characters
+ * @return True or false, whether the words of the file are in the segment of the worker that mapped it
+ */
+bool hasSharedOutputMarker(char * report, int reportLength) {
+    int markerSize = (int)sizeof(SHARED_OUTPUT_MARKER);
+    char * nameEnd = memchr(report, '\0', reportLength);
+
+    // The marker always follows the task name, a file could be named like it
+    return nameEnd != NULL && reportLength - markerSize > nameEnd - report &&
+           memcmp(report + reportLength - markerSize, SHARED_OUTPUT_MARKER, markerSize) == 0 &&
+           report[reportLength - markerSize - 1] == '\0';
+}
+
+/**
+ * Free the shared segments and the node communicator, collective over all the ranks
+ * @param shuffle The shuffle to free
+ */
+void freeSharedShuffle(struct SharedShuffle * shuffle) {
+    if (shuffle->window != MPI_WIN_NULL) {
+        if (shuffle->enabled) {
+            MPI_Win_unlock_all(shuffle->window);
+        }
+        MPI_Win_free(&shuffle->window);
+    }
+    if (shuffle->nodeComm != MPI_COMM_NULL) {
+        MPI_Comm_free(&shuffle->nodeComm);
+    }
+
+    free(shuffle->segments);
+    free(shuffle->segmentSizes);
+    free(shuffle->nodeOfRank);
+    free(shuffle->nodeRankOfRank);
+
+    shuffle->segments = NULL;
+    shuffle->segmentSizes = NULL;
+    shuffle->nodeOfRank = NULL;
+    shuffle->nodeRankOfRank = NULL;
+    shuffle->enabled = false;
+}
@@ -0,0 +1,162 @@
+/**
+ * Function library for the traces of the tasks of a run, recorded by the master and replayed by the scheduler simulator
+ *
+ * A trace is a text file with a line per completed task, in the order of completion:
+ *  {stage}\t{rank}\t{start}\t{end}\t{bytesRead}\t{bytesWritten}\t{arenaAllocations}\t{arenaPeakBytes}\t{name}
+ * The times are in microseconds since the start of the run, the name is last since file names can hold spaces.
+ * The tabs, line breaks and backslashes of a name are escaped as \t, \n, \r and \\, so that every task stays on its line.
+ * Lines starting with '#' are comments.
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include "../defs/TaskTrace.h"
+#include "../defs/Logging.h"
+
+/**
+ * Create a trace file and write its header
+ * @param path The path of the trace, an existing trace is replaced
+ * @return The open trace, or NULL in case it could not be created
+ */
+FILE * openTaskTrace(char * path) {
+    FILE * trace = fopen(path, "w");
+    if (!trace) {
+        printf("%sCould not create the task trace %s%s\n", KRED, path, KNRM);
+        return NULL;
+    }
+
+    fprintf(trace, "# stage\trank\tstart_us\tend_us\tbytes_read\tbytes_written\tarena_allocations\tarena_peak_bytes\tname\n");
+    return trace;
+}
+
+/**
+ * Write the name of a task, escaping the characters that would break its line
+ * @param trace The open trace
+ * @param name The name
+ */
+static void writeEscapedName(FILE * trace, char * name) {
+    for (char * c = name; *c; c++) {
+        switch (*c) {
+            case '\t':
+                fputs("\\t", trace);
+                break;
+            case '\n':
+                fputs("\\n", trace);
+                break;
+            case '\r':
+                fputs("\\r", trace);
+                break;
+            case '\\':
+                fputs("\\\\", trace);
+                break;
+            default:
+                fputc(*c, trace);
+        }
+    }
+}
+
+/**
+ * Restore a name written by writeEscapedName, in place
+ * @param name The escaped name
+ * @return The name
+ */
+static char * unescapeName(char * name) {
+    char * write = name;
+
+    for (char * read = name; *read; read++) {
+        if (*read == '\\' && read[1] != '\0') {
+            read++;
+            *write++ = *read == 't' ? '\t' : *read == 'n' ? '\n' : *read == 'r' ? '\r' : *read;
+        } else {
+            *write++ = *read;
+        }
+    }
+    *write = '\0';
+
+    return name;
+}
+
+/**
+ * Append a task to a trace
+ * @param trace The open trace
+ * @param record The task
+ */
+void writeTaskTraceRecord(FILE * trace, struct TaskTraceRecord * record) {
+    fprintf(trace, "%s\t%d\t%lld\t%lld\t%ld\t%ld\t%ld\t%ld\t", record->stage, record->rank,
+            (long long)record->start, (long long)record->end, record->bytesRead, record->bytesWritten,
+            record->arenaAllocations, record->arenaPeakBytes);
+    writeEscapedName(trace, record->name ? record->name : "");
+    fputc('\n', trace);
+}
+
+/**
+ * Read all the tasks of a trace
+ * @param path The path of the trace
+ * @param records Where the tasks are stored, allocated with malloc, see freeTaskTrace
+ * @return The number of tasks, or -1 in case the trace could not be read
+ */
+int readTaskTrace(char * path, struct TaskTraceRecord ** records) {
+    FILE * trace = fopen(path, "r");
+    if (!trace) {
+        printf("%sCould not read the task trace %s%s\n", KRED, path, KNRM);
+        return -1;
+    }
+
+    int numberOfRecords = 0;
+    int capacity = 1024;
+    *records = (struct TaskTraceRecord *)malloc(capacity * sizeof(struct TaskTraceRecord));
+
+    char * line = NULL;
+    size_t lineCapacity = 0;
+    ssize_t lineLength;
+    while ((lineLength = getline(&line, &lineCapacity, trace)) != -1) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        if (line[lineLength - 1] == '\n') {
+            line[lineLength - 1] = '\0';
+        }
+
+        if (numberOfRecords == capacity) {
+            capacity *= 2;
+            *records = (struct TaskTraceRecord *)realloc(*records, capacity * sizeof(struct TaskTraceRecord));
+        }
+
+        struct TaskTraceRecord * record = *records + numberOfRecords;
+        long long start, end;
+        int nameOffset = 0;
+        if (sscanf(line, "%31[^\t]\t%d\t%lld\t%lld\t%ld\t%ld\t%ld\t%ld\t%n", record->stage, &record->rank, &start, &end,
+                   &record->bytesRead, &record->bytesWritten, &record->arenaAllocations, &record->arenaPeakBytes,
+                   &nameOffset) < 8 || nameOffset == 0) {
+            printf("%sIgnoring the malformed trace line \"%s\"%s\n", KRED, line, KNRM);
+            continue;
+        }
+
+        record->start = start;
+        record->end = end;
+        record->name = strdup(unescapeName(line + nameOffset));
+        numberOfRecords++;
+    }
+
+    free(line);
+    fclose(trace);
+
+    return numberOfRecords;
+}
+
+/**
+ * Free the tasks of a trace
+ * @param records The tasks
+ * @param numberOfRecords The number of tasks
+ */
+void freeTaskTrace(struct TaskTraceRecord * records, int numberOfRecords) {
+    for (int i = 0; i < numberOfRecords; i++) {
+        free(records[i].name);
+    }
+    free(records);
+}
@@ -0,0 +1,133 @@
+/**
+ * Function library for a hash table that counts the appearances of words
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "../defs/WordCounter.h"
+
+/**
+ * Hash a word with the FNV-1a algorithm
+ * @param word The word to hash
+ * @param seed A value mixed into the hash, so that independent hashes of the same word can be obtained
+ * @return The hash of the word
+ */
+uint64_t hashWord(const char * word, uint64_t seed) {
+    uint64_t hash = 14695981039346656037ULL ^ (seed * 0x9E3779B97F4A7C15ULL);
+
+    for (const unsigned char * c = (const unsigned char *)word; *c; c++) {
+        hash ^= *c;
+        hash *= 1099511628211ULL;
+    }
+
+    // Final avalanche, so that the low bits can be used as a table index
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/**
+ * Initialize an empty word counter
+ * @param counter The counter to initialize
+ * @param initialCapacity The expected number of distinct words
+ */
+void initWordCounter(struct WordCounter * counter, int initialCapacity) {
+    int capacity = 16;
+    while (capacity < initialCapacity * 2) {
+        capacity *= 2;
+    }
+
+    counter->entries = (struct WordCount *)calloc(capacity, sizeof(struct WordCount));
+    counter->capacity = capacity;
+    counter->size = 0;
+}
+
+/**
+ * Find the slot of a word, or the empty slot where it would be inserted
+ * @param entries The slots of the table
+ * @param capacity The number of slots, a power of two
+ * @param word The word to look for
+ * @return The slot of the word
+ */
+static struct WordCount * findSlot(struct WordCount * entries, int capacity, char * word) {
+    uint64_t index = hashWord(word, 0) & (uint64_t)(capacity - 1);
+
+    while (entries[index].word && strcmp(entries[index].word, word) != 0) {
+        index = (index + 1) & (uint64_t)(capacity - 1);
+    }
+
+    return entries + index;
+}
+
+/**
+ * Double the capacity of a word counter
+ * @param counter The counter to grow
+ */
+static void growWordCounter(struct WordCounter * counter) {
+    int capacity = counter->capacity * 2;
+    struct WordCount * entries = (struct WordCount *)calloc(capacity, sizeof(struct WordCount));
+
+    for (int i = 0; i < counter->capacity; i++) {
+        if (counter->entries[i].word) {
+            *findSlot(entries, capacity, counter->entries[i].word) = counter->entries[i];
+        }
+    }
+
+    free(counter->entries);
+    counter->entries = entries;
+    counter->capacity = capacity;
+}
+
+/**
+ * Add to the number of appearances of a word, the word is copied the first time it is seen
+ * @param counter The counter to update
+ * @param word The word that appeared
+ * @param amount The number of appearances to add
+ * @return The updated number of appearances of the word
+ */
+long incrementWord(struct WordCounter * counter, char * word, long amount) {
+    if ((counter->size + 1) * 2 > counter->capacity) {
+        growWordCounter(counter);
+    }
+
+    struct WordCount * slot = findSlot(counter->entries, counter->capacity, word);
+    if (!slot->word) {
+        slot->word = strdup(word);
+        slot->count = 0;
+        counter->size++;
+    }
+
+    slot->count += amount;
+    return slot->count;
+}
+
+/**
+ * Get the number of appearances of a word
+ * @param counter The counter to look into
+ * @param word The word to look for
+ * @return The number of appearances of the word, 0 if it was never seen
+ */
+long getWordCount(struct WordCounter * counter, char * word) {
+    struct WordCount * slot = findSlot(counter->entries, counter->capacity, word);
+
+    return slot->word ? slot->count : 0;
+}
+
+/**
+ * Free the words and the table of a word counter
+ * @param counter The counter to free
+ */
+void freeWordCounter(struct WordCounter * counter) {
+    for (int i = 0; i < counter->capacity; i++) {
+        free(counter->entries[i].word);
+    }
+
+    free(counter->entries);
+    counter->entries = NULL;
+    counter->capacity = counter->size = 0;
+}
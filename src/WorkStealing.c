@@ -0,0 +1,257 @@
+/**
+ * Function library for the distributed scheduling of a phase, by work stealing between all the ranks
+ *
+ * The tasks of a phase are numbered, every rank starts with a contiguous block of them, and takes its next task
+ * from the front of its block. A rank that runs out of tasks sends steal requests to the other ranks,
+ * starting from a random one, and every victim answers with the back half of its remaining tasks.
+ * A rank that got an empty reply from every other rank in a row stops stealing, since the tasks are never created
+ * during a phase, at most one queued task per rank was left at that point.
+ *
+ * The end of the phase is detected with Safra's token algorithm: every rank counts the steal messages it sent minus
+ * the ones it received, and turns black when it receives one. The token goes around the ring from rank 0 and is only
+ * passed on by ranks that stopped stealing, adding their counter and color to it. The phase is over once the token
+ * returns white to a white rank 0 with a total of 0, which means that every rank is idle and no message is in flight.
+ * Rank 0 then tells the other ranks, and every rank leaves the phase without a message left to receive.
+ *
+ * @author Stefan Muraru
+ * @date 18.10.2026
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../defs/WorkStealing.h"
+#include "../defs/Utils.h"
+#include "../defs/Logging.h"
+
+/**
+ * Give the back half of the remaining tasks of the rank to a thief
+ * @param stealer The stealer of the rank
+ * @param thief The rank that asked for tasks
+ */
+static void answerStealRequest(struct WorkStealer * stealer, int thief) {
+    int remaining = stealer->last - stealer->first;
+    int given = remaining / 2;
+
+    stealer->last -= given;
+    MPI_Send(stealer->tasks + stealer->last, given, MPI_INT, thief, STEAL_REPLY, stealer->comm);
+    stealer->messageCounter++;
+}
+
+/**
+ * Receive the tasks given by a victim, an empty reply counts towards the end of the stealing of the rank
+ * @param stealer The stealer of the rank
+ * @param status The status of the probed reply
+ */
+static void receiveStealReply(struct WorkStealer * stealer, MPI_Status * status) {
+    int given;
+    MPI_Get_count(status, MPI_INT, &given);
+
+    // Tasks are only stolen once the block of the rank is done, so they take its place
+    MPI_Recv(stealer->tasks, given, MPI_INT, status->MPI_SOURCE, STEAL_REPLY, stealer->comm, MPI_STATUS_IGNORE);
+    stealer->first = 0;
+    stealer->last = given;
+    stealer->pendingVictim = -1;
+
+    if (given > 0) {
+        stealer->tasksStolen += given;
+        stealer->emptyReplies = 0;
+    } else {
+        stealer->emptyReplies++;
+    }
+}
+
+/**
+ * Receive and handle a message of the phase
+ * @param stealer The stealer of the rank
+ * @param wait Whether to wait for a message when none arrived yet
+ * @return True or false, whether a message was handled
+ */
+static bool handleStealMessage(struct WorkStealer * stealer, bool wait) {
+    MPI_Status status;
+    int arrived = true;
+
+    if (wait) {
+        MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, stealer->comm, &status);
+    } else {
+        MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, stealer->comm, &arrived, &status);
+    }
+
+    if (!arrived) {
+        return false;
+    }
+
+    switch (status.MPI_TAG) {
+        case STEAL_REQUEST: {
+            MPI_Recv(NULL, 0, MPI_INT, status.MPI_SOURCE, STEAL_REQUEST, stealer->comm, MPI_STATUS_IGNORE);
+            stealer->messageCounter--;
+            stealer->color = TOKEN_BLACK;
+
+            answerStealRequest(stealer, status.MPI_SOURCE);
+            break;
+        }
+
+        case STEAL_REPLY: {
+            receiveStealReply(stealer, &status);
+            stealer->messageCounter--;
+            stealer->color = TOKEN_BLACK;
+            break;
+        }
+
+        case STEAL_TOKEN: {
+            long token[2];
+            MPI_Recv(token, 2, MPI_LONG, status.MPI_SOURCE, STEAL_TOKEN, stealer->comm, MPI_STATUS_IGNORE);
+
+            stealer->holdsToken = true;
+            stealer->tokenCount = token[0];
+            stealer->tokenColor = (int)token[1];
+            break;
+        }
+
+        case STEAL_PHASE_DONE: {
+            MPI_Recv(NULL, 0, MPI_INT, status.MPI_SOURCE, STEAL_PHASE_DONE, stealer->comm, MPI_STATUS_IGNORE);
+            stealer->done = true;
+            break;
+        }
+
+        default: {
+            printf("%sRank %d -> Unexpected message %d from rank %d%s\n", KRED, stealer->rank, status.MPI_TAG, status.MPI_SOURCE, KNRM);
+            MPI_Recv(NULL, 0, MPI_BYTE, status.MPI_SOURCE, status.MPI_TAG, stealer->comm, MPI_STATUS_IGNORE);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Pass the token on, once the rank stopped stealing
+ * Rank 0 ends the phase when the token came back with no sign of activity, and starts a new round otherwise
+ * @param stealer The stealer of the rank
+ */
+static void passToken(struct WorkStealer * stealer) {
+    long token[2];
+    int next = (stealer->rank + 1) % stealer->numberOfRanks;
+
+    if (stealer->rank == 0) {
+        bool roundCompleted = stealer->tokenColor != -1;
+
+        if (roundCompleted &&
+            stealer->tokenColor == TOKEN_WHITE &&
+            stealer->color == TOKEN_WHITE &&
+            stealer->tokenCount + stealer->messageCounter == 0) {
+            for (int i = 1; i < stealer->numberOfRanks; i++) {
+                MPI_Send(NULL, 0, MPI_INT, i, STEAL_PHASE_DONE, stealer->comm);
+            }
+            stealer->done = true;
+            return;
+        }
+
+        token[0] = 0;
+        token[1] = TOKEN_WHITE;
+    } else {
+        token[0] = stealer->tokenCount + stealer->messageCounter;
+        token[1] = stealer->color == TOKEN_BLACK ? TOKEN_BLACK : stealer->tokenColor;
+    }
+
+    MPI_Send(token, 2, MPI_LONG, next, STEAL_TOKEN, stealer->comm);
+    stealer->color = TOKEN_WHITE;
+    stealer->holdsToken = false;
+}
+
+/**
+ * Start the scheduling of a phase, collective over all the ranks
+ * Every rank starts with a contiguous block of the tasks, rank 0 holds the token
+ * @param stealer The stealer to initialize
+ * @param numberOfTasks The number of tasks of the phase, the same on all the ranks
+ */
+void initWorkStealer(struct WorkStealer * stealer, int numberOfTasks) {
+    memset(stealer, 0, sizeof(struct WorkStealer));
+
+    // The messages of every phase stay on a communicator of their own
+    MPI_Comm_dup(MPI_COMM_WORLD, &stealer->comm);
+    MPI_Comm_rank(stealer->comm, &stealer->rank);
+    MPI_Comm_size(stealer->comm, &stealer->numberOfRanks);
+
+    stealer->tasks = (int *)malloc((numberOfTasks + 1) * sizeof(int));
+    int blockStart = (int)((long)numberOfTasks * stealer->rank / stealer->numberOfRanks);
+    int blockEnd = (int)((long)numberOfTasks * (stealer->rank + 1) / stealer->numberOfRanks);
+    for (int i = blockStart; i < blockEnd; i++) {
+        stealer->tasks[i - blockStart] = i;
+    }
+    stealer->first = 0;
+    stealer->last = blockEnd - blockStart;
+
+    stealer->pendingVictim = -1;
+    stealer->seed = (unsigned int)(getCurrentTimestamp() ^ (stealer->rank * 2654435761u));
+
+    // The token of rank 0 has not been around the ring yet
+    stealer->color = TOKEN_WHITE;
+    stealer->holdsToken = stealer->rank == 0;
+    stealer->tokenColor = -1;
+}
+
+/**
+ * Get the next task of the rank, stealing from the other ranks once its own tasks are done
+ * The steal requests of the other ranks are answered on every call, so it has to be called between tasks
+ * @param stealer The stealer of the rank
+ * @return The index of the next task, or -1 once all the tasks of the phase are done on all the ranks
+ */
+int getNextStolenTask(struct WorkStealer * stealer) {
+    while (true) {
+        while (!stealer->done && handleStealMessage(stealer, false));
+
+        if (stealer->done) {
+            return -1;
+        }
+
+        if (stealer->first < stealer->last) {
+            return stealer->tasks[stealer->first++];
+        }
+
+        // Every other rank is asked in turn, starting from a random one, until one of them has tasks to give
+        if (!stealer->quiescent && stealer->pendingVictim < 0) {
+            if (stealer->emptyReplies >= stealer->numberOfRanks - 1) {
+                stealer->quiescent = true;
+            } else {
+                if (stealer->emptyReplies == 0) {
+                    stealer->nextVictim = rand_r(&stealer->seed) % (stealer->numberOfRanks - 1);
+                    if (stealer->nextVictim >= stealer->rank) {
+                        stealer->nextVictim++;
+                    }
+                }
+
+                MPI_Send(NULL, 0, MPI_INT, stealer->nextVictim, STEAL_REQUEST, stealer->comm);
+                stealer->messageCounter++;
+                stealer->stealRequests++;
+                stealer->pendingVictim = stealer->nextVictim;
+
+                do {
+                    stealer->nextVictim = (stealer->nextVictim + 1) % stealer->numberOfRanks;
+                } while (stealer->nextVictim == stealer->rank);
+            }
+        }
+
+        if (stealer->quiescent && stealer->holdsToken) {
+            if (stealer->numberOfRanks == 1) {
+                stealer->done = true;
+                return -1;
+            }
+
+            passToken(stealer);
+            continue;
+        }
+
+        // Wait for the reply of the victim, the token or the end of the phase
+        handleStealMessage(stealer, true);
+    }
+}
+
+/**
+ * Free the stealer of a phase, collective over all the ranks, once getNextStolenTask returned -1 on all of them
+ * @param stealer The stealer to free
+ */
+void freeWorkStealer(struct WorkStealer * stealer) {
+    MPI_Comm_free(&stealer->comm);
+    free(stealer->tasks);
+    stealer->tasks = NULL;
+}